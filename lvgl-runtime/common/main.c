@@ -5,6 +5,14 @@
 #include <unistd.h>
 #include <math.h>
 #include <emscripten.h>
+#include <emscripten/heap.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "lvgl/lvgl.h"
 
@@ -20,10 +28,124 @@ int ver_res;
 uint32_t *display_fb;
 bool display_fb_dirty;
 
+// When set, LVGL renders straight into display_fb (DIRECT render mode), so there is
+// no separate draw buffer and no copy in my_driver_flush, but the pixels stay in
+// LVGL's BGRA byte order.
+static bool direct_render_mode = false;
+
+// LVGL draw buffer size in pixels set by init(), 0 means full screen
+static uint32_t draw_buffer_size = 0;
+static bool draw_buffer_double = false;
+static uint32_t draw_buffers_allocated = 0;
+
+#define MAX_DIRTY_AREAS 16
+
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} dirty_area_t;
+
+// Laid out as packed int32 values for the host: numAreas followed by
+// numAreas * [x1, y1, x2, y2] with inclusive coordinates.
+typedef struct {
+    int32_t numAreas;
+    dirty_area_t areas[MAX_DIRTY_AREAS];
+} dirty_areas_t;
+
+static dirty_areas_t display_fb_dirty_areas;
+static dirty_areas_t display_fb_synced_areas;
+
+static int32_t get_dirty_area_size(const dirty_area_t *area) {
+    return (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1);
+}
+
+static dirty_area_t join_dirty_areas(const dirty_area_t *a, const dirty_area_t *b) {
+    dirty_area_t result;
+    result.x1 = LV_MIN(a->x1, b->x1);
+    result.y1 = LV_MIN(a->y1, b->y1);
+    result.x2 = LV_MAX(a->x2, b->x2);
+    result.y2 = LV_MAX(a->y2, b->y2);
+    return result;
+}
+
+static void add_dirty_area(dirty_area_t area) {
+    dirty_area_t *areas = display_fb_dirty_areas.areas;
+
+    // merge with every area for which the bounding box doesn't cover more pixels than the two areas
+    int i = 0;
+    while (i < display_fb_dirty_areas.numAreas) {
+        dirty_area_t joined = join_dirty_areas(&area, &areas[i]);
+        if (get_dirty_area_size(&joined) <= get_dirty_area_size(&area) + get_dirty_area_size(&areas[i])) {
+            area = joined;
+            areas[i] = areas[--display_fb_dirty_areas.numAreas];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+
+    if (display_fb_dirty_areas.numAreas == MAX_DIRTY_AREAS) {
+        // list is full, merge with the area that grows the least
+        int best = 0;
+        int32_t bestGrowth = INT32_MAX;
+        for (i = 0; i < MAX_DIRTY_AREAS; i++) {
+            dirty_area_t joined = join_dirty_areas(&area, &areas[i]);
+            int32_t growth = get_dirty_area_size(&joined) - get_dirty_area_size(&areas[i]);
+            if (growth < bestGrowth) {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+        area = join_dirty_areas(&area, &areas[best]);
+        areas[best] = areas[--display_fb_dirty_areas.numAreas];
+        add_dirty_area(area);
+        return;
+    }
+
+    areas[display_fb_dirty_areas.numAreas++] = area;
+}
+
+// bgra -> rgba for numPixels consecutive pixels
+static void convert_bgra_to_rgba(uint8_t *dst, const uint8_t *src, int32_t numPixels) {
+    int32_t i = 0;
+
+#if defined(__wasm_simd128__)
+    for (; i + 4 <= numPixels; i += 4) {
+        v128_t pixels = wasm_v128_load(src + 4 * i);
+        wasm_v128_store(dst + 4 * i, wasm_i8x16_shuffle(pixels, pixels, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    }
+#elif defined(__SSSE3__)
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), _mm_shuffle_epi8(pixels, mask));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= numPixels; i += 16) {
+        uint8x16x4_t pixels = vld4q_u8(src + 4 * i);
+        uint8x16_t b = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = b;
+        vst4q_u8(dst + 4 * i, pixels);
+    }
+#endif
+
+    for (; i < numPixels; i++) {
+        uint32_t pixel;
+        memcpy(&pixel, src + 4 * i, 4);
+        pixel = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+        memcpy(dst + 4 * i, &pixel, 4);
+    }
+}
+
 #if LVGL_VERSION_MAJOR >= 9
 void my_driver_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *px_map) {
+    const uint8_t *src = px_map;
 #else
 void my_driver_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p) {
+    const uint8_t *src = (const uint8_t *)color_p;
 #endif
     /*Return if the area is out the screen */
     if (area->x2 < 0 || area->y2 < 0 || area->x1 > hor_res - 1 || area->y1 > ver_res - 1) {
@@ -31,41 +153,172 @@ void my_driver_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_
         return;
     }
 
-    uint8_t *dst = (uint8_t *)&display_fb[area->y1 * hor_res + area->x1];
-    uint32_t s = 4 * (hor_res - lv_area_get_width(area));
-    for (int y = area->y1; y <= area->y2 && y < ver_res; y++) {
-        for (int x = area->x1; x <= area->x2; x++) {
-#if LVGL_VERSION_MAJOR >= 9
-            uint8_t *src = px_map;
-            px_map += 4;
-#else
-            uint8_t *src = (uint8_t *)color_p++;
-#endif
-
-            // bgr -> rgb
-            *dst++ = src[2];
-            *dst++ = src[1];
-            *dst++ = src[0];
-            *dst++ = src[3];
+    if (!direct_render_mode) {
+        uint8_t *dst = (uint8_t *)&display_fb[area->y1 * hor_res + area->x1];
+        int32_t width = lv_area_get_width(area);
+        int32_t height = LV_MIN(area->y2, ver_res - 1) - area->y1 + 1;
+        if (width == hor_res) {
+            // rows are contiguous in both buffers
+            convert_bgra_to_rgba(dst, src, width * height);
+        } else {
+            for (int32_t y = 0; y < height; y++) {
+                convert_bgra_to_rgba(dst, src, width);
+                src += 4 * width;
+                dst += 4 * hor_res;
+            }
         }
+    }
 
-        dst += s;
+#if LVGL_VERSION_MAJOR < 9
+    if (direct_render_mode) {
+        // LVGL v8 passes the whole screen as the flush area in direct mode,
+        // so take the invalidated areas of this refresh instead
+        bool isLast = lv_disp_flush_is_last(disp_drv);
+        lv_disp_flush_ready(disp_drv);
+        if (isLast) {
+            lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+            for (uint16_t i = 0; i < disp->inv_p; i++) {
+                if (!disp->inv_area_joined[i]) {
+                    dirty_area_t dirtyArea;
+                    dirtyArea.x1 = LV_MAX(disp->inv_areas[i].x1, 0);
+                    dirtyArea.y1 = LV_MAX(disp->inv_areas[i].y1, 0);
+                    dirtyArea.x2 = LV_MIN(disp->inv_areas[i].x2, hor_res - 1);
+                    dirtyArea.y2 = LV_MIN(disp->inv_areas[i].y2, ver_res - 1);
+                    add_dirty_area(dirtyArea);
+                }
+            }
+            display_fb_dirty = true;
+        }
+        return;
     }
+#endif
 
     lv_disp_flush_ready(disp_drv);
 
+    dirty_area_t dirtyArea;
+    dirtyArea.x1 = LV_MAX(area->x1, 0);
+    dirtyArea.y1 = LV_MAX(area->y1, 0);
+    dirtyArea.x2 = LV_MIN(area->x2, hor_res - 1);
+    dirtyArea.y2 = LV_MIN(area->y2, ver_res - 1);
+    add_dirty_area(dirtyArea);
+
     display_fb_dirty = true;
 }
 
+// Input events are queued by the exported on*Event handlers and drained by the LVGL
+// read callbacks, one ring buffer per input device, so nothing is lost between two
+// LVGL reads. Both sides run on the main thread (the runtime is built without
+// pthreads), so the indices are plain integers and queued entries may be updated
+// or removed in place.
+
+#define INPUT_QUEUE_SIZE 64 // must be a power of 2
+
+typedef struct {
+    uint32_t timestamp; // emscripten_get_now() when the event was queued
+    int32_t x;
+    int32_t y;
+    uint32_t key;
+    int32_t diff;
+    bool pressed;
+} input_event_t;
+
+typedef struct {
+    input_event_t events[INPUT_QUEUE_SIZE];
+    unsigned head;
+    unsigned tail;
+} input_queue_t;
+
+static bool input_queue_push(input_queue_t *queue, input_event_t *event) {
+    if (queue->head - queue->tail == INPUT_QUEUE_SIZE) {
+        return false;
+    }
+    event->timestamp = (uint32_t)emscripten_get_now();
+    queue->events[queue->head & (INPUT_QUEUE_SIZE - 1)] = *event;
+    queue->head++;
+    return true;
+}
+
+static uint32_t input_latency_max = 0;
+
+static bool input_queue_pop(input_queue_t *queue, input_event_t *event) {
+    if (queue->head == queue->tail) {
+        return false;
+    }
+    *event = queue->events[queue->tail & (INPUT_QUEUE_SIZE - 1)];
+    queue->tail++;
+
+    uint32_t latency = (uint32_t)emscripten_get_now() - event->timestamp;
+    if (latency > input_latency_max) {
+        input_latency_max = latency;
+    }
+
+    return true;
+}
+
+static bool input_queue_is_empty(input_queue_t *queue) {
+    return queue->head == queue->tail;
+}
+
+static unsigned input_queue_size(input_queue_t *queue) {
+    return queue->head - queue->tail;
+}
+
+// i-th queued event counting from the oldest one
+static input_event_t *input_queue_at(input_queue_t *queue, unsigned i) {
+    return &queue->events[(queue->tail + i) & (INPUT_QUEUE_SIZE - 1)];
+}
+
+// the last queued event that has not been read yet, or NULL
+static input_event_t *input_queue_newest(input_queue_t *queue) {
+    if (queue->head == queue->tail) {
+        return NULL;
+    }
+    return input_queue_at(queue, queue->head - queue->tail - 1);
+}
+
+// removes the i-th queued event, the older ones move up by one
+static void input_queue_remove(input_queue_t *queue, unsigned i) {
+    for (; i > 0; i--) {
+        *input_queue_at(queue, i) = *input_queue_at(queue, i - 1);
+    }
+    queue->tail++;
+}
+
+// When set (LVGL v9 only), input devices run in LV_INDEV_MODE_EVENT and every queued
+// event is processed immediately instead of at the next indev read period.
+static bool input_event_mode = false;
+
+static input_queue_t pointer_queue;
+static bool pointer_queued_pressed = false; // pressed state of the last queued pointer event
+static bool pointer_queued_move = false;    // the last queued pointer event didn't change the pressed state
 static int mouse_x = 0;
 static int mouse_y = 0;
 static int mouse_pressed = 0;
 
-#define KEYBOARD_BUFFER_SIZE 1
-static uint32_t keyboard_buffer[KEYBOARD_BUFFER_SIZE];
-static uint32_t keyboard_buffer_index = 0;
+// Makes room in the full pointer queue by dropping the oldest move, i.e. the oldest
+// event with the same pressed state as the one before it. Without any move the oldest
+// press/release pair is dropped, so the queued events still alternate from mouse_pressed.
+static void pointer_queue_drop_oldest() {
+    bool pressed = mouse_pressed;
+    unsigned size = input_queue_size(&pointer_queue);
+    for (unsigned i = 0; i < size; i++) {
+        input_event_t *event = input_queue_at(&pointer_queue, i);
+        if (event->pressed == pressed) {
+            input_queue_remove(&pointer_queue, i);
+            return;
+        }
+        pressed = event->pressed;
+    }
+    input_queue_remove(&pointer_queue, 0);
+    input_queue_remove(&pointer_queue, 0);
+}
+
+static input_queue_t keyboard_queue;
 static bool keyboard_pressed = false;
 
+static input_queue_t mousewheel_queue;
+static int mouse_wheel_pressed = 0;
+
 #if LVGL_VERSION_MAJOR >= 9
 void my_mouse_read(lv_indev_t * indev_drv, lv_indev_data_t * data) {
 #else
@@ -73,10 +326,18 @@ void my_mouse_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data) {
 #endif
     EEZ_UNUSED(indev_drv);
 
+    input_event_t event;
+    if (input_queue_pop(&pointer_queue, &event)) {
+        mouse_x = event.x;
+        mouse_y = event.y;
+        mouse_pressed = event.pressed;
+    }
+
     /*Store the collected data*/
     data->point.x = (lv_coord_t)mouse_x;
     data->point.y = (lv_coord_t)mouse_y;
     data->state = mouse_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->continue_reading = !input_queue_is_empty(&pointer_queue);
 }
 
 #if LVGL_VERSION_MAJOR >= 9
@@ -86,23 +347,21 @@ void my_keyboard_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data) {
 #endif
     EEZ_UNUSED(indev_drv);
 
+    input_event_t event;
     if (keyboard_pressed) {
         /*Send a release manually*/
         keyboard_pressed = false;
         data->state = LV_INDEV_STATE_RELEASED;
-    } else if (keyboard_buffer_index > 0) {
-        /*Send the pressed character*/
+        data->continue_reading = !input_queue_is_empty(&keyboard_queue);
+    } else if (input_queue_pop(&keyboard_queue, &event)) {
+        /*Send the pressed character, the release follows in the same read*/
         keyboard_pressed = true;
         data->state = LV_INDEV_STATE_PRESSED;
-        data->key = keyboard_buffer[--keyboard_buffer_index];
+        data->key = event.key;
+        data->continue_reading = true;
     }
-
-
 }
 
-static int mouse_wheel_delta = 0;
-static int mouse_wheel_pressed = 0;
-
 #if LVGL_VERSION_MAJOR >= 9
 void my_mousewheel_read(lv_indev_t * indev_drv, lv_indev_data_t * data) {
 #else
@@ -110,10 +369,16 @@ void my_mousewheel_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data) {
 #endif
     (void) indev_drv;      /*Unused*/
 
-    data->state = mouse_wheel_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
-    data->enc_diff = (int16_t)mouse_wheel_delta;
+    input_event_t event;
+    if (input_queue_pop(&mousewheel_queue, &event)) {
+        mouse_wheel_pressed = event.pressed;
+        data->enc_diff = (int16_t)event.diff;
+    } else {
+        data->enc_diff = 0;
+    }
 
-    mouse_wheel_delta = 0;
+    data->state = mouse_wheel_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->continue_reading = !input_queue_is_empty(&mousewheel_queue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -261,6 +526,7 @@ static void init_fs_driver() {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+lv_indev_t *pointer_indev;
 lv_indev_t *encoder_indev;
 lv_indev_t *keyboard_indev;
 
@@ -277,18 +543,38 @@ EM_PORT_API(void) hal_init(bool is_editor) {//主函数调用初始化屏幕函
     display_fb = (uint32_t *)malloc(sizeof(uint32_t) * hor_res * ver_res);
     memset(display_fb, 0x44, hor_res * ver_res * sizeof(uint32_t));
 
+    // partial draw buffer must hold at least one line
+    uint32_t buf_size = hor_res * ver_res;
+    if (draw_buffer_size > 0 && draw_buffer_size < buf_size) {
+        buf_size = LV_MAX(draw_buffer_size, (uint32_t)hor_res);
+    }
+
 #if LVGL_VERSION_MAJOR >= 9
     lv_display_t * disp = lv_display_create(hor_res, ver_res);
     lv_display_set_flush_cb(disp, my_driver_flush);
 
-    uint8_t *buf1 = malloc(sizeof(uint32_t) * hor_res * ver_res);
-    uint8_t *buf2 = NULL;
-    lv_display_set_buffers(disp, buf1, buf2, sizeof(uint32_t) * hor_res * ver_res, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    if (direct_render_mode) {
+        lv_display_set_buffers(disp, display_fb, NULL, sizeof(uint32_t) * hor_res * ver_res, LV_DISPLAY_RENDER_MODE_DIRECT);
+    } else {
+        uint8_t *buf1 = malloc(sizeof(uint32_t) * buf_size);
+        uint8_t *buf2 = draw_buffer_double ? malloc(sizeof(uint32_t) * buf_size) : NULL;
+        lv_display_set_buffers(disp, buf1, buf2, sizeof(uint32_t) * buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        draw_buffers_allocated = sizeof(uint32_t) * buf_size * (buf2 ? 2 : 1);
+    }
 #else
     /*Create a display buffer*/
     static lv_disp_draw_buf_t disp_buf1;
-    lv_color_t * buf1_1 = malloc(sizeof(lv_color_t) * hor_res * ver_res);
-    lv_disp_draw_buf_init(&disp_buf1, buf1_1, NULL, hor_res * ver_res);
+    lv_color_t * buf1_1 = NULL;
+    lv_color_t * buf1_2 = NULL;
+    if (direct_render_mode) {
+        buf1_1 = (lv_color_t *)display_fb;
+        buf_size = hor_res * ver_res;
+    } else {
+        buf1_1 = malloc(sizeof(lv_color_t) * buf_size);
+        buf1_2 = draw_buffer_double ? malloc(sizeof(lv_color_t) * buf_size) : NULL;
+        draw_buffers_allocated = sizeof(lv_color_t) * buf_size * (buf1_2 ? 2 : 1);
+    }
+    lv_disp_draw_buf_init(&disp_buf1, buf1_1, buf1_2, buf_size);
 
     /*Create a display*/
     static lv_disp_drv_t disp_drv;
@@ -297,22 +583,25 @@ EM_PORT_API(void) hal_init(bool is_editor) {//主函数调用初始化屏幕函
     disp_drv.flush_cb = my_driver_flush;    /*Used when `LV_VDB_SIZE != 0` in lv_conf.h (buffered drawing)*/
     disp_drv.hor_res = hor_res;
     disp_drv.ver_res = ver_res;
+    disp_drv.direct_mode = direct_render_mode;
     lv_disp_drv_register(&disp_drv);
 #endif
 
     if (!is_editor) {
         // mouse init
 #if LVGL_VERSION_MAJOR >= 9
-        lv_indev_t * indev1 = lv_indev_create();
-        lv_indev_set_type(indev1, LV_INDEV_TYPE_POINTER);
-        lv_indev_set_read_cb(indev1, my_mouse_read);
-        //lv_indev_set_mode(indev1, LV_INDEV_MODE_EVENT);
+        pointer_indev = lv_indev_create();
+        lv_indev_set_type(pointer_indev, LV_INDEV_TYPE_POINTER);
+        lv_indev_set_read_cb(pointer_indev, my_mouse_read);
+        if (input_event_mode) {
+            lv_indev_set_mode(pointer_indev, LV_INDEV_MODE_EVENT);
+        }
 #else
         static lv_indev_drv_t indev_drv_1;
         lv_indev_drv_init(&indev_drv_1); /*Basic initialization*/
         indev_drv_1.type = LV_INDEV_TYPE_POINTER;
         indev_drv_1.read_cb = my_mouse_read;
-        lv_indev_drv_register(&indev_drv_1);
+        pointer_indev = lv_indev_drv_register(&indev_drv_1);
 #endif
 
         // keyboard init
@@ -320,7 +609,9 @@ EM_PORT_API(void) hal_init(bool is_editor) {//主函数调用初始化屏幕函
         keyboard_indev = lv_indev_create();
         lv_indev_set_type(keyboard_indev, LV_INDEV_TYPE_KEYPAD);
         lv_indev_set_read_cb(keyboard_indev, my_keyboard_read);
-        //lv_indev_set_mode(keyboard_indev, LV_INDEV_MODE_EVENT);
+        if (input_event_mode) {
+            lv_indev_set_mode(keyboard_indev, LV_INDEV_MODE_EVENT);
+        }
 #else
         static lv_indev_drv_t indev_drv_2;
         lv_indev_drv_init(&indev_drv_2);
@@ -334,7 +625,9 @@ EM_PORT_API(void) hal_init(bool is_editor) {//主函数调用初始化屏幕函
         encoder_indev = lv_indev_create();
         lv_indev_set_type(encoder_indev, LV_INDEV_TYPE_ENCODER);
         lv_indev_set_read_cb(encoder_indev, my_mousewheel_read);
-        //lv_indev_set_mode(encoder_indev, LV_INDEV_MODE_EVENT);
+        if (input_event_mode) {
+            lv_indev_set_mode(encoder_indev, LV_INDEV_MODE_EVENT);
+        }
 #else
         static lv_indev_drv_t indev_drv_3;
         lv_indev_drv_init(&indev_drv_3);
@@ -353,12 +646,17 @@ bool initialized = false;
 static uint32_t g_prevTick;
 #endif
 
-EM_PORT_API(void) init(uint32_t wasmModuleId, uint32_t debuggerMessageSubsciptionFilter, uint8_t *assets, uint32_t assetsSize, uint32_t displayWidth, uint32_t displayHeight, bool darkTheme, uint32_t timeZone, bool screensLifetimeSupport) {
+// drawBufferSize is the LVGL draw buffer size in pixels (e.g. 1/10 of the screen), 0 for full screen,
+// and drawBufferDouble adds a second buffer of the same size. Both can be omitted by older hosts.
+EM_PORT_API(void) init(uint32_t wasmModuleId, uint32_t debuggerMessageSubsciptionFilter, uint8_t *assets, uint32_t assetsSize, uint32_t displayWidth, uint32_t displayHeight, bool darkTheme, uint32_t timeZone, bool screensLifetimeSupport, uint32_t drawBufferSize, bool drawBufferDouble) {
     bool is_editor = assetsSize == 0;
 
     hor_res = displayWidth;
     ver_res = displayHeight;
 
+    draw_buffer_size = drawBufferSize;
+    draw_buffer_double = drawBufferDouble;
+
     /*Initialize LittlevGL*/
     lv_init();
 
@@ -400,41 +698,146 @@ EM_PORT_API(bool) mainLoop() {
 EM_PORT_API(uint8_t*) getSyncedBuffer() {
     if (display_fb_dirty) {
         display_fb_dirty = false;
+        display_fb_dirty_areas.numAreas = 0;
         return (uint8_t*)display_fb;
     }
 	return NULL;
 }
 
+// Returns the areas of the frame buffer changed since the last sync (see dirty_areas_t),
+// so the host copies only those from getDisplayBuffer(), or NULL if nothing changed.
+EM_PORT_API(dirty_areas_t*) getSyncedAreas() {
+    if (display_fb_dirty) {
+        display_fb_dirty = false;
+        display_fb_synced_areas = display_fb_dirty_areas;
+        display_fb_dirty_areas.numAreas = 0;
+        return &display_fb_synced_areas;
+    }
+    return NULL;
+}
+
+EM_PORT_API(uint8_t*) getDisplayBuffer() {
+    return (uint8_t*)display_fb;
+}
+
+// Must be called before init().
+EM_PORT_API(void) setDirectRenderMode(bool enabled) {
+    if (!initialized) {
+        direct_render_mode = enabled;
+    }
+}
+
+static char g_memoryReport[512];
+
+// Returns the memory used by this instance as a JSON object (all sizes in bytes).
+EM_PORT_API(const char *) getMemoryReport() {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    snprintf(g_memoryReport, sizeof(g_memoryReport),
+        "{\"frameBuffer\":%u,\"drawBuffers\":%u,\"debuggerBuffer\":%u,"
+        "\"lvglHeapTotal\":%u,\"lvglHeapUsed\":%u,\"lvglHeapMaxUsed\":%u,\"wasmHeap\":%u}",
+        display_fb ? (unsigned)(sizeof(uint32_t) * hor_res * ver_res) : 0,
+        (unsigned)draw_buffers_allocated,
+        (unsigned)flowGetDebuggerBufferSize(),
+        (unsigned)mon.total_size, (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.max_used,
+        (unsigned)emscripten_get_heap_size());
+
+    return g_memoryReport;
+}
+
+// Returns true if the frame buffer is in BGRA byte order (direct render mode), otherwise it is RGBA.
+EM_PORT_API(bool) isDisplayBufferBGRA() {
+    return direct_render_mode;
+}
+
 EM_PORT_API(bool) isRTL() {
     return false;
 }
 
+static void process_input_event(lv_indev_t *indev) {
+#if LVGL_VERSION_MAJOR >= 9
+    if (input_event_mode && indev) {
+        lv_indev_read(indev);
+    }
+#else
+    EEZ_UNUSED(indev);
+#endif
+}
+
 EM_PORT_API(void) onPointerEvent(int x, int y, int pressed) {
+    input_event_t event = { 0 };
+
     if (x < 0) x = 0;
     else if (x >= hor_res) x = hor_res - 1;
-    mouse_x = x;
+    event.x = x;
 
     if (y < 0) y = 0;
     else if (y >= ver_res) y = ver_res - 1;
-    mouse_y = y;
+    event.y = y;
+
+    event.pressed = pressed;
+
+    // Once the queue is half full, consecutive moves are merged into the newest
+    // entry. When it is full, the oldest queued move is dropped to make room, so
+    // presses and releases are kept in order and the newest position is never lost.
+    bool isMove = event.pressed == pointer_queued_pressed;
+    input_event_t *newest = input_queue_newest(&pointer_queue);
+    if (isMove && pointer_queued_move && newest && input_queue_size(&pointer_queue) >= INPUT_QUEUE_SIZE / 2) {
+        newest->x = event.x;
+        newest->y = event.y;
+    } else if (!input_queue_push(&pointer_queue, &event)) {
+        pointer_queue_drop_oldest();
+        input_queue_push(&pointer_queue, &event);
+    }
+    pointer_queued_pressed = event.pressed;
+    pointer_queued_move = isMove;
 
-    mouse_pressed = pressed;
+    process_input_event(pointer_indev);
 }
 
 EM_PORT_API(void) onMouseWheelEvent(double yMouseWheel, int pressed) {
+    input_event_t event = { 0 };
+
     if (yMouseWheel >= 100 || yMouseWheel <= -100) {
         yMouseWheel /= 100;
     }
-    mouse_wheel_delta = round(yMouseWheel);
-    mouse_wheel_pressed = pressed;
+    event.diff = round(yMouseWheel);
+    event.pressed = pressed;
+
+    if (!input_queue_push(&mousewheel_queue, &event)) {
+        // queue is full: fold the event into the newest entry, keeping the total rotation
+        input_event_t *newest = input_queue_newest(&mousewheel_queue);
+        newest->diff += event.diff;
+        newest->pressed = event.pressed;
+    }
+
+    process_input_event(encoder_indev);
 }
 
 EM_PORT_API(void) onKeyPressed(uint32_t key) {
-    if (keyboard_buffer_index < KEYBOARD_BUFFER_SIZE) {
-        keyboard_buffer[keyboard_buffer_index++] = key;
+    input_event_t event = { 0 };
+    event.key = key;
+
+    if (input_queue_push(&keyboard_queue, &event)) {
+        process_input_event(keyboard_indev);
+    }
+}
+
+// Must be called before init(), only supported with LVGL v9.
+EM_PORT_API(void) setInputEventMode(bool enabled) {
+    if (!initialized) {
+        input_event_mode = enabled;
     }
 }
 
+// Returns the longest time in ms an input event waited in a queue since the previous call.
+EM_PORT_API(uint32_t) getInputLatency() {
+    uint32_t latency = input_latency_max;
+    input_latency_max = 0;
+    return latency;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #define SYMBOLS_STRING_INIT_ALLOCATED 1024 * 1024
@@ -1,4 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string>
 #include <vector>
 #include <map>
 #include <emscripten.h>
@@ -8,6 +11,7 @@
 #include <eez/core/action.h>
 #include <eez/core/vars.h>
 #include <eez/core/util.h>
+#include <eez/core/alloc.h>
 
 #include <eez/flow/flow.h>
 #include <eez/flow/expression.h>
@@ -419,26 +423,44 @@ void startToDebuggerMessage() {
     }, eez::flow::g_wasmModuleId);
 }
 
-static char g_debuggerBuffer[1024 * 1024];
+#define DEBUGGER_BUFFER_SIZE (1024 * 1024)
+
+// allocated on the first message to the debugger
+static char *g_debuggerBuffer = nullptr;
 static uint32_t g_debuggerBufferIndex = 0;
 
+static void sendToDebugger(const char *buffer, uint32_t length) {
+    EM_ASM({
+        writeDebuggerBuffer($0, new Uint8Array(Module.HEAPU8.buffer, $1, $2));
+    }, eez::flow::g_wasmModuleId, buffer, length);
+}
+
 void writeDebuggerBuffer(const char *buffer, uint32_t length) {
-    if (g_debuggerBufferIndex + length > sizeof(g_debuggerBuffer)) {
-        EM_ASM({
-            writeDebuggerBuffer($0, new Uint8Array(Module.HEAPU8.buffer, $1, $2));
-        }, eez::flow::g_wasmModuleId, g_debuggerBuffer, g_debuggerBufferIndex);
+    if (!g_debuggerBuffer) {
+        g_debuggerBuffer = (char *)malloc(DEBUGGER_BUFFER_SIZE);
+    }
+
+    if (g_debuggerBufferIndex + length > DEBUGGER_BUFFER_SIZE && g_debuggerBufferIndex > 0) {
+        sendToDebugger(g_debuggerBuffer, g_debuggerBufferIndex);
         g_debuggerBufferIndex = 0;
-    } else {
-        memcpy(g_debuggerBuffer + g_debuggerBufferIndex, buffer, length);
-        g_debuggerBufferIndex += length;
     }
+
+    if (!g_debuggerBuffer || length > DEBUGGER_BUFFER_SIZE) {
+        sendToDebugger(buffer, length);
+        return;
+    }
+
+    memcpy(g_debuggerBuffer + g_debuggerBufferIndex, buffer, length);
+    g_debuggerBufferIndex += length;
+}
+
+extern "C" uint32_t flowGetDebuggerBufferSize() {
+    return g_debuggerBuffer ? DEBUGGER_BUFFER_SIZE : 0;
 }
 
 void finishToDebuggerMessage() {
     if (g_debuggerBufferIndex > 0) {
-        EM_ASM({
-            writeDebuggerBuffer($0, new Uint8Array(Module.HEAPU8.buffer, $1, $2));
-        }, eez::flow::g_wasmModuleId, g_debuggerBuffer, g_debuggerBufferIndex);
+        sendToDebugger(g_debuggerBuffer, g_debuggerBufferIndex);
         g_debuggerBufferIndex = 0;
     }
 
@@ -473,6 +495,33 @@ EM_PORT_API(void) setDebuggerMessageSubsciptionFilter(uint32_t filter) {
     eez::flow::setDebuggerMessageSubsciptionFilter(filter);
 }
 
+static std::string g_allocStatsString;
+
+// Returns per allocation site statistics as a JSON array. Only populated when
+// the flow engine has the allocation statistics API (EEZ_HAS_ALLOC_STATS) and
+// is compiled with EEZ_OPTION_ALLOC_PROFILE, otherwise the array is empty.
+EM_PORT_API(const char *) getAllocStats() {
+#if defined(EEZ_HAS_ALLOC_STATS)
+    std::vector<eez::AllocStats> stats(eez::getNumAllocStats());
+    stats.resize(eez::getAllocStats(stats.data(), stats.size()));
+
+    g_allocStatsString = "[";
+    for (size_t i = 0; i < stats.size(); i++) {
+        char buffer[160];
+        snprintf(buffer, sizeof(buffer),
+            "%s{\"id\":\"%08" PRIx32 "\",\"liveBytes\":%" PRIu32 ",\"liveCount\":%" PRIu32 ",\"totalCount\":%" PRIu32 ",\"peakBytes\":%" PRIu32 "}",
+            i > 0 ? "," : "",
+            stats[i].id, stats[i].liveBytes, stats[i].liveCount, stats[i].totalCount, stats[i].peakBytes);
+        g_allocStatsString += buffer;
+    }
+    g_allocStatsString += "]";
+#else
+    g_allocStatsString = "[]";
+#endif
+
+    return g_allocStatsString.c_str();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static std::map<int, lv_obj_t *> indexToObject;
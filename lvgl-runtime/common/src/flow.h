@@ -15,6 +15,7 @@ extern "C" {
 #endif
 void flowInit(uint32_t wasmModuleId, uint32_t debuggerMessageSubsciptionFilter, uint8_t *assets, uint32_t assetsSize, bool darkTheme, uint32_t timeZone, bool screensLifetimeSupport);
 bool flowTick();
+uint32_t flowGetDebuggerBufferSize();
 #ifdef __cplusplus
 }
 #endif
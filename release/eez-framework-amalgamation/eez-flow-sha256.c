@@ -21,13 +21,26 @@
 #define ROTLEFT(a,b) (((a) << (b)) | ((a) >> (32-(b))))
 #define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
 
-#define CH(x,y,z) (((x) & (y)) ^ (~(x) & (z)))
-#define MAJ(x,y,z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define CH(x,y,z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x,y,z) (((x) & (y)) | ((z) & ((x) | (y))))
 #define EP0(x) (ROTRIGHT(x,2) ^ ROTRIGHT(x,13) ^ ROTRIGHT(x,22))
 #define EP1(x) (ROTRIGHT(x,6) ^ ROTRIGHT(x,11) ^ ROTRIGHT(x,25))
 #define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
 #define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
 
+#define LOAD_BE32(p) (((WORD)(p)[0] << 24) | ((WORD)(p)[1] << 16) | ((WORD)(p)[2] << 8) | ((WORD)(p)[3]))
+
+// One round with the working variables passed in rotated order, so the
+// unrolled loop below never has to shift a..h between rounds.
+#define ROUND(a,b,c,d,e,f,g,h,i) \
+	t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[(i) & 15]; \
+	d += t1; \
+	h = t1 + EP0(a) + MAJ(a,b,c)
+
+// Expands the next schedule word in place in the 16 word rolling window.
+#define SCHEDULE(i) \
+	m[(i) & 15] += SIG1(m[((i) - 2) & 15]) + m[((i) - 7) & 15] + SIG0(m[((i) - 15) & 15])
+
 /**************************** VARIABLES *****************************/
 static const WORD k[64] = {
 	0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
@@ -41,45 +54,105 @@ static const WORD k[64] = {
 };
 
 /*********************** FUNCTION DEFINITIONS ***********************/
-void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+#if defined(__SHA__) && defined(__SSE4_1__)
+#include <immintrin.h>
+
+// x86 SHA extensions: four rounds per pair of sha256rnds2 and the message
+// schedule computed with sha256msg1/sha256msg2.
+static void sha256_transform_blocks(SHA256_CTX *ctx, const BYTE data[], size_t blocks)
 {
-	WORD a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
-
-	for (i = 0, j = 0; i < 16; ++i, j += 4)
-		m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-	for ( ; i < 64; ++i)
-		m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
-
-	a = ctx->state[0];
-	b = ctx->state[1];
-	c = ctx->state[2];
-	d = ctx->state[3];
-	e = ctx->state[4];
-	f = ctx->state[5];
-	g = ctx->state[6];
-	h = ctx->state[7];
-
-	for (i = 0; i < 64; ++i) {
-		t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
-		t2 = EP0(a) + MAJ(a,b,c);
-		h = g;
-		g = f;
-		f = e;
-		e = d + t1;
-		d = c;
-		c = b;
-		b = a;
-		a = t1 + t2;
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, tmp, msg, abef, cdgh, w[4];
+	int j;
+
+	tmp = _mm_loadu_si128((const __m128i *)&ctx->state[0]);
+	state1 = _mm_loadu_si128((const __m128i *)&ctx->state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);
+	state1 = _mm_shuffle_epi32(state1, 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	while (blocks--) {
+		abef = state0;
+		cdgh = state1;
+
+		for (j = 0; j < 16; ++j) {
+			if (j < 4)
+				w[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * j)), mask);
+			else
+				w[j & 3] = _mm_sha256msg2_epu32(
+					_mm_add_epi32(_mm_sha256msg1_epu32(w[j & 3], w[(j + 1) & 3]), _mm_alignr_epi8(w[(j + 3) & 3], w[(j + 2) & 3], 4)),
+					w[(j + 3) & 3]);
+			msg = _mm_add_epi32(w[j & 3], _mm_loadu_si128((const __m128i *)&k[4 * j]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+		data += 64;
 	}
 
-	ctx->state[0] += a;
-	ctx->state[1] += b;
-	ctx->state[2] += c;
-	ctx->state[3] += d;
-	ctx->state[4] += e;
-	ctx->state[5] += f;
-	ctx->state[6] += g;
-	ctx->state[7] += h;
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i *)&ctx->state[0], state0);
+	_mm_storeu_si128((__m128i *)&ctx->state[4], state1);
+}
+
+#else
+
+static void sha256_transform_blocks(SHA256_CTX *ctx, const BYTE data[], size_t blocks)
+{
+	WORD a, b, c, d, e, f, g, h, i, t1, m[16];
+
+	while (blocks--) {
+		for (i = 0; i < 16; ++i)
+			m[i] = LOAD_BE32(data + 4 * i);
+
+		a = ctx->state[0];
+		b = ctx->state[1];
+		c = ctx->state[2];
+		d = ctx->state[3];
+		e = ctx->state[4];
+		f = ctx->state[5];
+		g = ctx->state[6];
+		h = ctx->state[7];
+
+		for (i = 0; i < 64; i += 8) {
+			if (i >= 16) {
+				SCHEDULE(i); SCHEDULE(i + 1); SCHEDULE(i + 2); SCHEDULE(i + 3);
+				SCHEDULE(i + 4); SCHEDULE(i + 5); SCHEDULE(i + 6); SCHEDULE(i + 7);
+			}
+			ROUND(a, b, c, d, e, f, g, h, i);
+			ROUND(h, a, b, c, d, e, f, g, i + 1);
+			ROUND(g, h, a, b, c, d, e, f, i + 2);
+			ROUND(f, g, h, a, b, c, d, e, i + 3);
+			ROUND(e, f, g, h, a, b, c, d, i + 4);
+			ROUND(d, e, f, g, h, a, b, c, i + 5);
+			ROUND(c, d, e, f, g, h, a, b, i + 6);
+			ROUND(b, c, d, e, f, g, h, a, i + 7);
+		}
+
+		ctx->state[0] += a;
+		ctx->state[1] += b;
+		ctx->state[2] += c;
+		ctx->state[3] += d;
+		ctx->state[4] += e;
+		ctx->state[5] += f;
+		ctx->state[6] += g;
+		ctx->state[7] += h;
+
+		data += 64;
+	}
+}
+
+#endif
+
+void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+{
+	sha256_transform_blocks(ctx, data, 1);
 }
 
 void sha256_init(SHA256_CTX *ctx)
@@ -98,16 +171,36 @@ void sha256_init(SHA256_CTX *ctx)
 
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len)
 {
-	WORD i;
+	size_t n, blocks;
+
+	// Top up a partially filled block first.
+	if (ctx->datalen > 0) {
+		n = 64 - ctx->datalen;
+		if (n > len)
+			n = len;
+		memcpy(ctx->data + ctx->datalen, data, n);
+		ctx->datalen += n;
+		data += n;
+		len -= n;
+		if (ctx->datalen < 64)
+			return;
+		sha256_transform_blocks(ctx, ctx->data, 1);
+		ctx->bitlen += 512;
+		ctx->datalen = 0;
+	}
 
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		if (ctx->datalen == 64) {
-			sha256_transform(ctx, ctx->data);
-			ctx->bitlen += 512;
-			ctx->datalen = 0;
-		}
+	// Whole blocks are hashed straight from the input.
+	blocks = len / 64;
+	if (blocks > 0) {
+		sha256_transform_blocks(ctx, data, blocks);
+		ctx->bitlen += 512ULL * blocks;
+		data += blocks * 64;
+		len -= blocks * 64;
+	}
+
+	if (len > 0) {
+		memcpy(ctx->data, data, len);
+		ctx->datalen = len;
 	}
 }
 
@@ -34,32 +34,337 @@ void executeActionFunction(int actionId) {
 #include <assert.h>
 #include <string.h>
 namespace eez {
-void initAllocHeap(uint8_t *heap, size_t heapSize) {
-    EEZ_UNUSED(heap);
-    EEZ_UNUSED(heapSize);
-}
-void *alloc(size_t size, uint32_t id) {
-    EEZ_UNUSED(id);
+#if !defined(EEZ_ALLOC_SLAB_PAGE_SIZE)
+#define EEZ_ALLOC_SLAB_PAGE_SIZE 4096
+#endif
+static const size_t SLAB_PAGE_SIZE = EEZ_ALLOC_SLAB_PAGE_SIZE;
+static const size_t SLAB_MAX_OBJECT_SIZE = 256;
+static const uint16_t SLAB_OBJECT_SIZES[] = { 8, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+static const unsigned NUM_SLAB_CLASSES = sizeof(SLAB_OBJECT_SIZES) / sizeof(SLAB_OBJECT_SIZES[0]);
+static const uint8_t SLAB_CLASS_FOR_SIZE[SLAB_MAX_OBJECT_SIZE / 8 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+};
+struct SlabObject {
+    SlabObject *next;
+};
+struct SlabPage {
+    SlabPage *prev;
+    SlabPage *next;
+    SlabObject *freeList;
+    uint16_t sizeClass;
+    uint16_t numUsed;
+    uint16_t numCarved;
+    uint16_t capacity;
+};
+static const size_t SLAB_PAGE_HEADER_SIZE = (sizeof(SlabPage) + 7) & ~(size_t)7;
+static SlabPage *g_slabPartialPages[NUM_SLAB_CLASSES];
+static SlabPage **g_slabPages;
+static uint32_t g_numSlabPages;
+static uint32_t g_slabPagesCapacity;
+static uintptr_t g_slabLowAddress = UINTPTR_MAX;
+static uintptr_t g_slabHighAddress;
+static void *lvglAlloc(size_t size) {
 #if LVGL_VERSION_MAJOR >= 9
     return lv_malloc(size);
 #else
     return lv_mem_alloc(size);
 #endif
 }
-void free(void *ptr) {
+static void lvglFree(void *ptr) {
 #if LVGL_VERSION_MAJOR >= 9
     lv_free(ptr);
 #else
     lv_mem_free(ptr);
 #endif
 }
-template<typename T> void freeObject(T *ptr) {
-	ptr->~T();
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
+static uint32_t findSlabPageIndex(uintptr_t address) {
+    uint32_t lo = 0;
+    uint32_t hi = g_numSlabPages;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if ((uintptr_t)g_slabPages[mid] <= address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+static SlabPage *findSlabPage(void *ptr) {
+    uintptr_t address = (uintptr_t)ptr;
+    if (address < g_slabLowAddress || address >= g_slabHighAddress) {
+        return nullptr;
+    }
+    uint32_t index = findSlabPageIndex(address);
+    if (index == 0) {
+        return nullptr;
+    }
+    SlabPage *page = g_slabPages[index - 1];
+    return address < (uintptr_t)page + SLAB_PAGE_SIZE ? page : nullptr;
+}
+static void updateSlabAddressRange() {
+    if (g_numSlabPages == 0) {
+        g_slabLowAddress = UINTPTR_MAX;
+        g_slabHighAddress = 0;
+    } else {
+        g_slabLowAddress = (uintptr_t)g_slabPages[0];
+        g_slabHighAddress = (uintptr_t)g_slabPages[g_numSlabPages - 1] + SLAB_PAGE_SIZE;
+    }
+}
+static bool registerSlabPage(SlabPage *page) {
+    if (g_numSlabPages == g_slabPagesCapacity) {
+        uint32_t newCapacity = g_slabPagesCapacity ? 2 * g_slabPagesCapacity : 32;
+        auto newPages = (SlabPage **)lvglAlloc(newCapacity * sizeof(SlabPage *));
+        if (!newPages) {
+            return false;
+        }
+        if (g_slabPages) {
+            memcpy(newPages, g_slabPages, g_numSlabPages * sizeof(SlabPage *));
+            lvglFree(g_slabPages);
+        }
+        g_slabPages = newPages;
+        g_slabPagesCapacity = newCapacity;
+    }
+    uint32_t index = findSlabPageIndex((uintptr_t)page);
+    memmove(g_slabPages + index + 1, g_slabPages + index, (g_numSlabPages - index) * sizeof(SlabPage *));
+    g_slabPages[index] = page;
+    g_numSlabPages++;
+    updateSlabAddressRange();
+    return true;
+}
+static void unregisterSlabPage(SlabPage *page) {
+    uint32_t index = findSlabPageIndex((uintptr_t)page) - 1;
+    memmove(g_slabPages + index, g_slabPages + index + 1, (g_numSlabPages - index - 1) * sizeof(SlabPage *));
+    g_numSlabPages--;
+    updateSlabAddressRange();
+}
+static void linkPartialSlabPage(SlabPage *page) {
+    SlabPage *&head = g_slabPartialPages[page->sizeClass];
+    page->prev = nullptr;
+    page->next = head;
+    if (head) {
+        head->prev = page;
+    }
+    head = page;
+}
+static void unlinkPartialSlabPage(SlabPage *page) {
+    if (page->prev) {
+        page->prev->next = page->next;
+    } else {
+        g_slabPartialPages[page->sizeClass] = page->next;
+    }
+    if (page->next) {
+        page->next->prev = page->prev;
+    }
+    page->prev = nullptr;
+    page->next = nullptr;
+}
+static SlabPage *allocSlabPage(unsigned sizeClass) {
+    auto page = (SlabPage *)lvglAlloc(SLAB_PAGE_SIZE);
+    if (!page) {
+        return nullptr;
+    }
+    if (!registerSlabPage(page)) {
+        lvglFree(page);
+        return nullptr;
+    }
+    page->freeList = nullptr;
+    page->sizeClass = (uint16_t)sizeClass;
+    page->numUsed = 0;
+    page->numCarved = 0;
+    page->capacity = (uint16_t)((SLAB_PAGE_SIZE - SLAB_PAGE_HEADER_SIZE) / SLAB_OBJECT_SIZES[sizeClass]);
+    linkPartialSlabPage(page);
+    return page;
+}
+static void *slabAlloc(size_t size) {
+    unsigned sizeClass = SLAB_CLASS_FOR_SIZE[(size + 7) >> 3];
+    SlabPage *page = g_slabPartialPages[sizeClass];
+    if (!page) {
+        page = allocSlabPage(sizeClass);
+        if (!page) {
+            return nullptr;
+        }
+    }
+    void *ptr;
+    if (page->freeList) {
+        ptr = page->freeList;
+        page->freeList = page->freeList->next;
+    } else {
+        ptr = (uint8_t *)page + SLAB_PAGE_HEADER_SIZE + page->numCarved * SLAB_OBJECT_SIZES[sizeClass];
+        page->numCarved++;
+    }
+    if (++page->numUsed == page->capacity) {
+        unlinkPartialSlabPage(page);
+    }
+    return ptr;
+}
+static void slabFree(SlabPage *page, void *ptr) {
+    if (page->numUsed == page->capacity) {
+        linkPartialSlabPage(page);
+    }
+    auto object = (SlabObject *)ptr;
+    object->next = page->freeList;
+    page->freeList = object;
+    page->numUsed--;
+}
+void initAllocHeap(uint8_t *heap, size_t heapSize) {
+    EEZ_UNUSED(heap);
+    EEZ_UNUSED(heapSize);
+}
+static void *allocBlock(size_t size) {
+    if (size <= SLAB_MAX_OBJECT_SIZE) {
+        void *ptr = slabAlloc(size);
+        if (ptr) {
+            return ptr;
+        }
+    }
+    return lvglAlloc(size);
+}
+static void freeBlock(void *ptr) {
+    SlabPage *page = findSlabPage(ptr);
+    if (page) {
+        slabFree(page, ptr);
+    } else {
+        lvglFree(ptr);
+    }
+}
+#if EEZ_OPTION_ALLOC_PROFILE
+struct AllocHeader {
+    uint32_t id;
+    uint32_t size;
+};
+static AllocStats *g_allocStats;
+static uint32_t g_allocStatsCapacity;
+static uint32_t g_numAllocStats;
+static uint32_t hashAllocId(uint32_t id) {
+    return id * 2654435761u;
+}
+static AllocStats *findAllocStats(AllocStats *table, uint32_t capacity, uint32_t id) {
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = hashAllocId(id) & mask; ; i = (i + 1) & mask) {
+        if (table[i].totalCount == 0 || table[i].id == id) {
+            return &table[i];
+        }
+    }
+}
+static bool growAllocStats() {
+    uint32_t newCapacity = g_allocStatsCapacity ? 2 * g_allocStatsCapacity : 256;
+    auto newTable = (AllocStats *)lvglAlloc(newCapacity * sizeof(AllocStats));
+    if (!newTable) {
+        return false;
+    }
+    memset(newTable, 0, newCapacity * sizeof(AllocStats));
+    for (uint32_t i = 0; i < g_allocStatsCapacity; i++) {
+        if (g_allocStats[i].totalCount != 0) {
+            *findAllocStats(newTable, newCapacity, g_allocStats[i].id) = g_allocStats[i];
+        }
+    }
+    if (g_allocStats) {
+        lvglFree(g_allocStats);
+    }
+    g_allocStats = newTable;
+    g_allocStatsCapacity = newCapacity;
+    return true;
+}
+static void recordAlloc(uint32_t id, uint32_t size) {
+    if (2 * (g_numAllocStats + 1) > g_allocStatsCapacity && !growAllocStats()) {
+        return;
+    }
+    AllocStats *stats = findAllocStats(g_allocStats, g_allocStatsCapacity, id);
+    if (stats->totalCount == 0) {
+        stats->id = id;
+        g_numAllocStats++;
+    }
+    stats->totalCount++;
+    stats->liveCount++;
+    stats->liveBytes += size;
+    if (stats->liveBytes > stats->peakBytes) {
+        stats->peakBytes = stats->liveBytes;
+    }
+}
+static void recordFree(uint32_t id, uint32_t size) {
+    if (!g_allocStats) {
+        return;
+    }
+    AllocStats *stats = findAllocStats(g_allocStats, g_allocStatsCapacity, id);
+    if (stats->totalCount != 0 && stats->liveCount > 0) {
+        stats->liveCount--;
+        stats->liveBytes -= size;
+    }
+}
+void *alloc(size_t size, uint32_t id) {
+    auto header = (AllocHeader *)allocBlock(sizeof(AllocHeader) + size);
+    if (!header) {
+        return nullptr;
+    }
+    header->id = id;
+    header->size = (uint32_t)size;
+    recordAlloc(id, (uint32_t)size);
+    return header + 1;
+}
+void free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto header = (AllocHeader *)ptr - 1;
+    recordFree(header->id, header->size);
+    freeBlock(header);
+}
+uint32_t getAllocStats(AllocStats *stats, uint32_t maxStats) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < g_allocStatsCapacity && n < maxStats; i++) {
+        if (g_allocStats[i].totalCount != 0) {
+            stats[n++] = g_allocStats[i];
+        }
+    }
+    return n;
+}
+uint32_t getNumAllocStats() {
+    return g_numAllocStats;
+}
 #else
-	lv_mem_free(ptr);
+void *alloc(size_t size, uint32_t id) {
+    EEZ_UNUSED(id);
+    return allocBlock(size);
+}
+void free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    freeBlock(ptr);
+}
+uint32_t getAllocStats(AllocStats *stats, uint32_t maxStats) {
+    EEZ_UNUSED(stats);
+    EEZ_UNUSED(maxStats);
+    return 0;
+}
+uint32_t getNumAllocStats() {
+    return 0;
+}
 #endif
+template<typename T> void freeObject(T *ptr) {
+	ptr->~T();
+	free(ptr);
+}
+void trimAllocHeap() {
+    for (unsigned sizeClass = 0; sizeClass < NUM_SLAB_CLASSES; sizeClass++) {
+        SlabPage *page = g_slabPartialPages[sizeClass];
+        while (page) {
+            SlabPage *next = page->next;
+            if (page->numUsed == 0) {
+                unlinkPartialSlabPage(page);
+                unregisterSlabPage(page);
+                lvglFree(page);
+            }
+            page = next;
+        }
+    }
+    if (g_numSlabPages == 0 && g_slabPages) {
+        lvglFree(g_slabPages);
+        g_slabPages = nullptr;
+        g_slabPagesCapacity = 0;
+    }
 }
 void getAllocInfo(uint32_t &free, uint32_t &alloc) {
     lv_mem_monitor_t mon;
@@ -582,33 +887,203 @@ void stringAppendStringLength(char *str, size_t maxStrLength, const char *value,
         strncat(str, value, n);
     }
 }
-void stringAppendInt(char *str, size_t maxStrLength, int value) {
+static const char g_decimalDigitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+static const double g_formatPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+uint32_t getDecimalDigitCount(uint64_t value) {
+    uint32_t numDigits = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        numDigits += 4;
+    }
+    if (value >= 1000) {
+        return numDigits + 3;
+    }
+    if (value >= 100) {
+        return numDigits + 2;
+    }
+    if (value >= 10) {
+        return numDigits + 1;
+    }
+    return numDigits;
+}
+void writeDecimalDigits(char *str, uint64_t value, uint32_t numDigits) {
+    char *p = str + numDigits;
+    while (value > 0xFFFFFFFF && p - str >= 2) {
+        p -= 2;
+        memcpy(p, g_decimalDigitPairs + 2 * (value % 100), 2);
+        value /= 100;
+    }
+    uint32_t value32 = (uint32_t)value;
+    while (p - str >= 2) {
+        p -= 2;
+        memcpy(p, g_decimalDigitPairs + 2 * (value32 % 100), 2);
+        value32 /= 100;
+    }
+    if (p > str) {
+        *--p = '0' + value32 % 10;
+    }
+}
+int formatUInt64(char *str, uint64_t value) {
+    uint32_t numDigits = getDecimalDigitCount(value);
+    writeDecimalDigits(str, value, numDigits);
+    str[numDigits] = 0;
+    return numDigits;
+}
+int formatInt64(char *str, int64_t value) {
+    if (value < 0) {
+        *str = '-';
+        return 1 + formatUInt64(str + 1, 0 - (uint64_t)value);
+    }
+    return formatUInt64(str, (uint64_t)value);
+}
+static bool roundToSignificantDigits(double value, int &exponent, uint32_t &digits) {
+    for (int i = 0; i < 3; i++) {
+        int scaleExponent = 5 - exponent;
+        if (scaleExponent < -22 || scaleExponent > 22) {
+            return false;
+        }
+        double scaled;
+        double error;
+        if (scaleExponent >= 0) {
+            double scale = g_formatPowersOf10[scaleExponent];
+            scaled = value * scale;
+            error = fma(value, scale, -scaled);
+        } else {
+            double scale = g_formatPowersOf10[-scaleExponent];
+            scaled = value / scale;
+            error = fma(-scaled, scale, value);
+        }
+        if (scaled < 1e5) {
+            exponent--;
+            continue;
+        }
+        if (scaled >= 1e6) {
+            exponent++;
+            continue;
+        }
+        double rounded = nearbyint(scaled);
+        if (fabs(scaled - rounded) == 0.5) {
+            if (error > 0 && rounded < scaled) {
+                rounded += 1;
+            } else if (error < 0 && rounded > scaled) {
+                rounded -= 1;
+            }
+        }
+        if (rounded >= 1e6) {
+            rounded = 1e5;
+            exponent++;
+        }
+        digits = (uint32_t)rounded;
+        return true;
+    }
+    return false;
+}
+int formatDouble(char *str, double value) {
+    if (!isfinite(value)) {
+        return snprintf(str, FORMAT_DOUBLE_MAX_LENGTH, "%g", value);
+    }
+    char *p = str;
+    if (signbit(value)) {
+        *p++ = '-';
+    }
+    double absValue = fabs(value);
+    if (absValue == 0) {
+        *p++ = '0';
+        *p = 0;
+        return p - str;
+    }
+    int exponent = (int)floor(log10(absValue));
+    uint32_t significantDigits;
+    if (!roundToSignificantDigits(absValue, exponent, significantDigits)) {
+        return snprintf(str, FORMAT_DOUBLE_MAX_LENGTH, "%g", value);
+    }
+    char digits[6];
+    writeDecimalDigits(digits, significantDigits, 6);
+    int numDigits = 6;
+    while (numDigits > 1 && digits[numDigits - 1] == '0') {
+        numDigits--;
+    }
+    if (exponent >= -4 && exponent < 6) {
+        if (exponent >= 0) {
+            int numIntegerDigits = exponent + 1;
+            memcpy(p, digits, numIntegerDigits);
+            p += numIntegerDigits;
+            if (numDigits > numIntegerDigits) {
+                *p++ = '.';
+                memcpy(p, digits + numIntegerDigits, numDigits - numIntegerDigits);
+                p += numDigits - numIntegerDigits;
+            }
+        } else {
+            *p++ = '0';
+            *p++ = '.';
+            for (int i = -1; i > exponent; i--) {
+                *p++ = '0';
+            }
+            memcpy(p, digits, numDigits);
+            p += numDigits;
+        }
+    } else {
+        *p++ = digits[0];
+        if (numDigits > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, numDigits - 1);
+            p += numDigits - 1;
+        }
+        *p++ = 'e';
+        if (exponent < 0) {
+            *p++ = '-';
+            exponent = -exponent;
+        } else {
+            *p++ = '+';
+        }
+        uint32_t numExponentDigits = exponent < 100 ? 2 : 3;
+        writeDecimalDigits(p, exponent, numExponentDigits);
+        p += numExponentDigits;
+    }
+    *p = 0;
+    return p - str;
+}
+static void stringAppendFormatted(char *str, size_t maxStrLength, const char *text, int len) {
     auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%d", value);
+    if (n >= maxStrLength) {
+        return;
+    }
+    if ((size_t)len > maxStrLength - n - 1) {
+        len = maxStrLength - n - 1;
+    }
+    memcpy(str + n, text, len);
+    str[n + len] = 0;
+}
+void stringAppendInt(char *str, size_t maxStrLength, int value) {
+    char text[FORMAT_INTEGER_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatInt64(text, value));
 }
 void stringAppendUInt32(char *str, size_t maxStrLength, uint32_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%lu", (unsigned long)value);
+    char text[FORMAT_INTEGER_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatUInt64(text, value));
 }
 void stringAppendInt64(char *str, size_t maxStrLength, int64_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%jd", value);
+    char text[FORMAT_INTEGER_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatInt64(text, value));
 }
 void stringAppendUInt64(char *str, size_t maxStrLength, uint64_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%ju", value);
+    char text[FORMAT_INTEGER_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatUInt64(text, value));
 }
 void stringAppendFloat(char *str, size_t maxStrLength, float value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%g", value);
+    char text[FORMAT_DOUBLE_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatDouble(text, value));
 }
 void stringAppendFloat(char *str, size_t maxStrLength, float value, int numDecimalPlaces) {
     auto n = strlen(str);
     snprintf(str + n, maxStrLength - n, "%.*f", numDecimalPlaces, value);
 }
 void stringAppendDouble(char *str, size_t maxStrLength, double value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%g", value);
+    char text[FORMAT_DOUBLE_MAX_LENGTH];
+    stringAppendFormatted(str, maxStrLength, text, formatDouble(text, value));
 }
 void stringAppendDouble(char *str, size_t maxStrLength, double value, int numDecimalPlaces) {
     auto n = strlen(str);
@@ -1226,6 +1701,7 @@ EasingFuncType g_easingFuncs[] = {
 // -----------------------------------------------------------------------------
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 #include <ctype.h>
@@ -1620,9 +2096,16 @@ static const char *WIDGET_value_type_name(const Value &value) {
     return "widget";
 }
 static bool compare_JSON_value(const Value &a, const Value &b) {
+    if (isJsonRef(a)) {
+        return isSameJsonNode(a, b);
+    }
     return a.type == b.type && a.int32Value == b.int32Value;
 }
 static void JSON_value_to_text(const Value &value, char *text, int count) {
+    if (isJsonRef(value)) {
+        jsonToText(value, text, count);
+        return;
+    }
     snprintf(text, count, "json (id=%d)", value.getInt());
 }
 static const char *JSON_value_type_name(const Value &value) {
@@ -1660,6 +2143,16 @@ static void PROPERTY_REF_value_to_text(const Value &value, char *text, int count
     snprintf(text, count, "property-ref (flowState=%p, component=%d, property=%d)",
         (void *)value.getPropertyRef()->flowState, value.getPropertyRef()->componentIndex, value.getPropertyRef()->propertyIndex);
 }
+static bool compare_SHA256_CONTEXT_value(const Value &a, const Value &b) {
+    return a.type == b.type && a.refValue == b.refValue;
+}
+static void SHA256_CONTEXT_value_to_text(const Value &value, char *text, int count) {
+    snprintf(text, count, "sha256-context (%p)", (void *)value.refValue);
+}
+static const char *SHA256_CONTEXT_value_type_name(const Value &value) {
+    EEZ_UNUSED(value);
+    return "sha256-context";
+}
 static bool compare_DATE_value(const Value &a, const Value &b) {
     return a.type == b.type && a.doubleValue == b.doubleValue;
 }
@@ -1846,6 +2339,11 @@ ValueTypeNameFunction g_valueTypeNames[] = {
 	VALUE_TYPES
 };
 #undef VALUE_TYPE
+StringRef::~StringRef() {
+    if (jsonRef && --jsonRef->refCounter == 0) {
+        ObjectAllocator<Ref>::deallocate(jsonRef);
+    }
+}
 ArrayValueRef::~ArrayValueRef() {
     eez::flow::onArrayValueFree(&arrayValue);
     for (uint32_t i = 1; i < arrayValue.arraySize; i++) {
@@ -1899,14 +2397,30 @@ Value MakeEnumDefinitionValue(uint8_t enumValue, uint8_t enumDefinition) {
     return value;
 }
 const char *Value::getString() const {
-    auto value = getValue(); 
-	if (value.type == VALUE_TYPE_STRING_REF) {
-		return ((StringRef *)value.refValue)->str;
+	if (type == VALUE_TYPE_STRING_REF) {
+		return ((StringRef *)refValue)->str;
+	}
+	if (type == VALUE_TYPE_STRING) {
+		return strValue;
+	}
+	if (type == VALUE_TYPE_STRING_ASSET) {
+		return (const char *)((uint8_t *)&int32Value + int32Value);
+	}
+	if (type == VALUE_TYPE_VALUE_PTR) {
+		return pValueValue->getString();
+	}
+	if (!isIndirectValueType()) {
+		return nullptr;
 	}
-	if (value.type == VALUE_TYPE_STRING) {
-		return value.strValue;
+    auto value = getValue();
+	return value.getString();
+}
+uint32_t Value::getStringLength() const {
+	if (type == VALUE_TYPE_STRING_REF) {
+		return ((StringRef *)refValue)->len;
 	}
-	return nullptr;
+	const char *str = getString();
+	return str ? strlen(str) : 0;
 }
 const ArrayValue *Value::getArray() const {
     if (type == VALUE_TYPE_ARRAY) {
@@ -2200,7 +2714,7 @@ bool Value::toBool(int *err) const {
         return array->arraySize != 0;
 	}
     if (isJson()) {
-        return int32Value != 0;
+        return isJsonRef(*this) || int32Value != 0;
     }
     if (isWidget()) {
         return pVoidValue != 0;
@@ -2210,6 +2724,35 @@ bool Value::toBool(int *err) const {
     }
 	return false;
 }
+static char *allocString(Value &value, uint32_t len, uint32_t id) {
+    auto ptr = alloc(sizeof(StringRef) + len + 1, id);
+    if (ptr == nullptr) {
+        value = Value(0, VALUE_TYPE_NULL);
+        return nullptr;
+    }
+    auto stringRef = new (ptr) StringRef;
+    char *str = (char *)(stringRef + 1);
+    str[len] = 0;
+    stringRef->refCounter = 1;
+    stringRef->len = len;
+    stringRef->str = str;
+    stringRef->jsonRef = nullptr;
+    value.type = VALUE_TYPE_STRING_REF;
+    value.options = VALUE_OPTIONS_REF;
+    value.refValue = stringRef;
+    return str;
+}
+Value Value::makeStringRef(const char *str, int len, uint32_t id) {
+	if (len == -1) {
+		len = strlen(str);
+	}
+    Value value;
+    char *dst = allocString(value, len, id);
+    if (dst) {
+        strncpy(dst, str, len);
+    }
+	return value;
+}
 Value Value::toString(uint32_t id) const {
 	if (isIndirectValueType()) {
 		return getValue().toString(id);
@@ -2217,95 +2760,98 @@ Value Value::toString(uint32_t id) const {
 	if (isString()) {
 		return *this;
 	}
+    if (type == VALUE_TYPE_INT64 || type == VALUE_TYPE_UINT64 || (isInt32OrLess() && type != VALUE_TYPE_BOOLEAN)) {
+        bool negative = false;
+        uint64_t absValue;
+        if (type == VALUE_TYPE_UINT64) {
+            absValue = uint64Value;
+        } else {
+            int64_t intValue = toInt64();
+            negative = intValue < 0;
+            absValue = negative ? 0 - (uint64_t)intValue : (uint64_t)intValue;
+        }
+        uint32_t numDigits = getDecimalDigitCount(absValue);
+        Value value;
+        char *dst = allocString(value, numDigits + (negative ? 1 : 0), id);
+        if (dst) {
+            if (negative) {
+                *dst++ = '-';
+            }
+            writeDecimalDigits(dst, absValue, numDigits);
+        }
+        return value;
+    }
     char tempStr[64];
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable : 4474)
-#endif
+    int len;
     if (type == VALUE_TYPE_DOUBLE) {
-        snprintf(tempStr, sizeof(tempStr), "%g", doubleValue);
+        len = formatDouble(tempStr, doubleValue);
     } else if (type == VALUE_TYPE_FLOAT) {
-        snprintf(tempStr, sizeof(tempStr), "%g", floatValue);
-    } else if (type == VALUE_TYPE_INT8) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId8 "", int8Value);
-    } else if (type == VALUE_TYPE_UINT8) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu8 "", uint8Value);
-    } else if (type == VALUE_TYPE_INT16) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId16 "", int16Value);
-    } else if (type == VALUE_TYPE_UINT16) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu16 "", uint16Value);
-    } else if (type == VALUE_TYPE_INT32) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId32 "", int32Value);
-    } else if (type == VALUE_TYPE_UINT32) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu32 "", uint32Value);
-    } else if (type == VALUE_TYPE_INT64) {
-#ifdef PRId64
-        snprintf(tempStr, sizeof(tempStr), "%" PRId64 "", int64Value);
-#else
-        snprintf(tempStr, sizeof(tempStr), "%" PRId32 "", (int32_t)int64Value);
-#endif
-    } else if (type == VALUE_TYPE_UINT64) {
-#ifdef PRIu64
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu64 "", uint64Value);
-#else
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu32 "", (uint32_t)uint64Value);
-#endif
+        len = formatDouble(tempStr, floatValue);
     } else {
         toText(tempStr, sizeof(tempStr));
+        len = strlen(tempStr);
     }
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
-	return makeStringRef(tempStr, strlen(tempStr), id);
+	return makeStringRef(tempStr, len, id);
 }
-Value Value::makeStringRef(const char *str, int len, uint32_t id) {
-    auto stringRef = ObjectAllocator<StringRef>::allocate(id);
-	if (stringRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
-	}
-	if (len == -1) {
-		len = strlen(str);
-	}
-    stringRef->str = (char *)alloc(len + 1, id + 1);
-    if (stringRef->str == nullptr) {
-        ObjectAllocator<StringRef>::deallocate(stringRef);
+Value Value::makeStringSliceRef(const Value &str, const char *chars, uint32_t len, uint32_t id) {
+    auto sliceRef = ObjectAllocator<StringSliceRef>::allocate(id);
+    if (sliceRef == nullptr) {
         return Value(0, VALUE_TYPE_NULL);
     }
-    stringCopyLength(stringRef->str, len + 1, str, len);
-	stringRef->str[len] = 0;
-    stringRef->refCounter = 1;
+    sliceRef->refCounter = 1;
+    sliceRef->len = len;
+    sliceRef->str = chars;
+    sliceRef->jsonRef = nullptr;
+    sliceRef->baseValue = str;
     Value value;
     value.type = VALUE_TYPE_STRING_REF;
     value.options = VALUE_OPTIONS_REF;
-    value.refValue = stringRef;
-	return value;
+    value.refValue = sliceRef;
+    return value;
 }
-Value Value::concatenateString(const Value &str1, const Value &str2) {
-    auto stringRef = ObjectAllocator<StringRef>::allocate(0xbab14c6a);;
-	if (stringRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
-	}
-    auto newStrLen = strlen(str1.getString()) + strlen(str2.getString()) + 1;
-    stringRef->str = (char *)alloc(newStrLen, 0xb5320162);
-    if (stringRef->str == nullptr) {
-        ObjectAllocator<StringRef>::deallocate(stringRef);
-        return Value(0, VALUE_TYPE_NULL);
+Value Value::makeStringSuffixRef(const Value &str, uint32_t offset, uint32_t id) {
+    uint32_t len = str.getStringLength();
+    if (offset >= len) {
+        return Value("", VALUE_TYPE_STRING);
     }
-    stringCopy(stringRef->str, newStrLen, str1.getString());
-    stringAppendString(stringRef->str, newStrLen, str2.getString());
-    stringRef->refCounter = 1;
+    if (str.type == VALUE_TYPE_STRING_REF && len - offset >= sizeof(StringSliceRef)) {
+        return makeStringSliceRef(str, str.getString() + offset, len - offset, id);
+    }
+    if (str.type == VALUE_TYPE_STRING_ASSET) {
+        return Value(str.getString() + offset, VALUE_TYPE_STRING);
+    }
+    return makeStringRef(str.getString() + offset, len - offset, id);
+}
+Value Value::concatenateString(const Value &str1, const Value &str2) {
+    const char *s1 = str1.getString();
+    const char *s2 = str2.getString();
+    uint32_t len1 = str1.getStringLength();
+    uint32_t len2 = str2.getStringLength();
     Value value;
-    value.type = VALUE_TYPE_STRING_REF;
-    value.options = VALUE_OPTIONS_REF;
-    value.refValue = stringRef;
+    char *dst = allocString(value, len1 + len2, 0xbab14c6a);
+    if (dst) {
+        memcpy(dst, s1, len1);
+        memcpy(dst + len1, s2, len2);
+    }
 	return value;
 }
-Value Value::makeArrayRef(int arraySize, int arrayType, uint32_t id) {
-    auto ptr = alloc(sizeof(ArrayValueRef) + (arraySize > 0 ? arraySize - 1 : 0) * sizeof(Value), id);
+static ArrayValueRef *allocArrayValueRef(uint32_t capacity, uint32_t id) {
+    auto ptr = alloc(sizeof(ArrayValueRef) + (capacity > 0 ? capacity - 1 : 0) * sizeof(Value), id);
 	if (ptr == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
+		return nullptr;
 	}
     ArrayValueRef *arrayRef = new (ptr) ArrayValueRef;
+    arrayRef->capacity = capacity > 0 ? capacity : 1;
+    return arrayRef;
+}
+Value Value::makeArrayRef(int arraySize, int arrayType, uint32_t id) {
+    return makeArrayRef(arraySize, arrayType, id, arraySize);
+}
+Value Value::makeArrayRef(int arraySize, int arrayType, uint32_t id, uint32_t capacity) {
+    ArrayValueRef *arrayRef = allocArrayValueRef(capacity > (uint32_t)arraySize ? capacity : arraySize, id);
+	if (arrayRef == nullptr) {
+		return Value(0, VALUE_TYPE_NULL);
+	}
     arrayRef->arrayValue.arraySize = arraySize;
     arrayRef->arrayValue.arrayType = arrayType;
     for (int i = 1; i < arraySize; i++) {
@@ -2318,27 +2864,148 @@ Value Value::makeArrayRef(int arraySize, int arrayType, uint32_t id) {
     value.refValue = arrayRef;
 	return value;
 }
-Value Value::makeArrayElementRef(Value arrayValue, int elementIndex, uint32_t id) {
-    auto arrayElementValueRef = ObjectAllocator<ArrayElementValue>::allocate(id);
-	if (arrayElementValueRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
-	}
-    arrayElementValueRef->arrayValue = arrayValue;
-    arrayElementValueRef->elementIndex = elementIndex;
-    arrayElementValueRef->refCounter = 1;
-    Value value;
-    value.type = VALUE_TYPE_ARRAY_ELEMENT_VALUE;
-    value.options = VALUE_OPTIONS_REF;
-    value.refValue = arrayElementValueRef;
-	return value;
+bool isUniqueArrayRef(const Value &arrayValue) {
+    return arrayValue.type == VALUE_TYPE_ARRAY_REF && arrayValue.refValue->refCounter == 1;
 }
-Value Value::makeJsonMemberRef(Value jsonValue, Value propertyName, uint32_t id) {
-    auto jsonMemberValueRef = ObjectAllocator<JsonMemberValue>::allocate(id);
-	if (jsonMemberValueRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
+static bool reserveArrayCapacity(Value &arrayValue, uint32_t capacity) {
+    auto arrayRef = (ArrayValueRef *)arrayValue.refValue;
+    if (capacity <= arrayRef->capacity) {
+        return true;
+    }
+    auto &array = arrayRef->arrayValue;
+    auto newArrayValue = Value::makeArrayRef(array.arraySize, array.arrayType, 0x5a0c7e19, capacity);
+    if (!newArrayValue.isArray()) {
+        return false;
+    }
+    auto newArray = newArrayValue.getArray();
+    for (uint32_t i = 0; i < array.arraySize; i++) {
+        newArray->values[i] = std::move(array.values[i]);
+    }
+    arrayValue = std::move(newArrayValue);
+    return true;
+}
+bool insertArrayElement(Value &arrayValue, uint32_t position, const Value &elementValue) {
+    auto arrayRef = (ArrayValueRef *)arrayValue.refValue;
+    uint32_t arraySize = arrayRef->arrayValue.arraySize;
+    if (arraySize == arrayRef->capacity) {
+        if (!reserveArrayCapacity(arrayValue, arrayRef->capacity + arrayRef->capacity / 2 + 4)) {
+            return false;
+        }
+        arrayRef = (ArrayValueRef *)arrayValue.refValue;
+    }
+    auto values = arrayRef->arrayValue.values;
+    if (position > arraySize) {
+        position = arraySize;
+    }
+    if (arraySize == 0) {
+        values[0] = elementValue;
+    } else {
+        memmove((void *)(values + position + 1), (const void *)(values + position), (arraySize - position) * sizeof(Value));
+        new (values + position) Value(elementValue);
+    }
+    arrayRef->arrayValue.arraySize = arraySize + 1;
+    return true;
+}
+void removeArrayElement(Value &arrayValue, uint32_t position) {
+    auto arrayRef = (ArrayValueRef *)arrayValue.refValue;
+    uint32_t arraySize = arrayRef->arrayValue.arraySize;
+    auto values = arrayRef->arrayValue.values;
+    if (position >= arraySize) {
+        return;
+    }
+    if (arraySize == 1) {
+        values[0] = Value();
+    } else {
+        values[position].~Value();
+        memmove((void *)(values + position), (const void *)(values + position + 1), (arraySize - position - 1) * sizeof(Value));
+    }
+    arrayRef->arrayValue.arraySize = arraySize - 1;
+}
+void sliceArrayElements(Value &arrayValue, uint32_t from, uint32_t to) {
+    auto arrayRef = (ArrayValueRef *)arrayValue.refValue;
+    uint32_t arraySize = arrayRef->arrayValue.arraySize;
+    auto values = arrayRef->arrayValue.values;
+    if (to > arraySize) {
+        to = arraySize;
+    }
+    if (from > to) {
+        from = to;
+    }
+    if (from == to) {
+        for (uint32_t i = 1; i < arraySize; i++) {
+            values[i].~Value();
+        }
+        values[0] = Value();
+    } else {
+        for (uint32_t i = to; i < arraySize; i++) {
+            values[i].~Value();
+        }
+        if (from > 0) {
+            for (uint32_t i = 0; i < from; i++) {
+                values[i].~Value();
+            }
+            memmove((void *)values, (const void *)(values + from), (to - from) * sizeof(Value));
+        }
+    }
+    arrayRef->arrayValue.arraySize = to - from;
+}
+bool hasArrayElements(const Value &arrayValue) {
+    auto array = arrayValue.getArray();
+    for (uint32_t i = 0; i < array->arraySize; i++) {
+        if (array->values[i].isArray()) {
+            return true;
+        }
+    }
+    return false;
+}
+bool isPrimitiveArrayType(uint32_t arrayType) {
+    return arrayType == flow::defs_v3::ARRAY_TYPE_INTEGER || arrayType == flow::defs_v3::ARRAY_TYPE_FLOAT || arrayType == flow::defs_v3::ARRAY_TYPE_DOUBLE || arrayType == flow::defs_v3::ARRAY_TYPE_BOOLEAN;
+}
+void copyArrayElements(Value *dstValues, const Value *srcValues, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    memcpy((void *)dstValues, (const void *)srcValues, count * sizeof(Value));
+    for (uint32_t i = 0; i < count; i++) {
+        const Value &srcValue = srcValues[i];
+        if (srcValue.options & VALUE_OPTIONS_REF) {
+            srcValue.refValue->refCounter++;
+        } else if (srcValue.type == VALUE_TYPE_STRING_ASSET || srcValue.type == VALUE_TYPE_ARRAY_ASSET) {
+            new (dstValues + i) Value(srcValue);
+        }
+    }
+}
+const Value *getStructFieldValue(const Value &structValue, uint32_t fieldIndex) {
+    if (!structValue.isArray()) {
+        return nullptr;
+    }
+    auto structArray = structValue.getArray();
+    if (fieldIndex >= structArray->arraySize) {
+        return nullptr;
+    }
+    return &structArray->values[fieldIndex];
+}
+Value Value::makeArrayElementRef(Value arrayValue, int elementIndex, uint32_t id) {
+    auto arrayElementValueRef = ObjectAllocator<ArrayElementValue>::allocate(id);
+	if (arrayElementValueRef == nullptr) {
+		return Value(0, VALUE_TYPE_NULL);
+	}
+    arrayElementValueRef->arrayValue = std::move(arrayValue);
+    arrayElementValueRef->elementIndex = elementIndex;
+    arrayElementValueRef->refCounter = 1;
+    Value value;
+    value.type = VALUE_TYPE_ARRAY_ELEMENT_VALUE;
+    value.options = VALUE_OPTIONS_REF;
+    value.refValue = arrayElementValueRef;
+	return value;
+}
+Value Value::makeJsonMemberRef(Value jsonValue, Value propertyName, uint32_t id) {
+    auto jsonMemberValueRef = ObjectAllocator<JsonMemberValue>::allocate(id);
+	if (jsonMemberValueRef == nullptr) {
+		return Value(0, VALUE_TYPE_NULL);
 	}
-    jsonMemberValueRef->jsonValue = jsonValue;
-    jsonMemberValueRef->propertyName = propertyName;
+    jsonMemberValueRef->jsonValue = std::move(jsonValue);
+    jsonMemberValueRef->propertyName = std::move(propertyName);
     jsonMemberValueRef->refCounter = 1;
     Value value;
     value.type = VALUE_TYPE_JSON_MEMBER_VALUE;
@@ -2434,6 +3101,20 @@ Value Value::clone() {
         auto array = getArray();
         auto resultArrayValue = makeArrayRef(array->arraySize, array->arrayType, 0x0ea48dcb);
         auto resultArray = resultArrayValue.getArray();
+        if (isPrimitiveArrayType(array->arrayType)) {
+            copyArrayElements(resultArray->values, array->values, array->arraySize);
+            for (uint32_t elementIndex = 0; elementIndex < array->arraySize; elementIndex++) {
+                auto &elementValue = resultArray->values[elementIndex];
+                if (elementValue.isArray() || elementValue.isString()) {
+                    auto clonedValue = elementValue.clone();
+                    if (clonedValue.isError()) {
+                        return clonedValue;
+                    }
+                    elementValue = std::move(clonedValue);
+                }
+            }
+            return resultArrayValue;
+        }
         for (uint32_t elementIndex = 0; elementIndex < array->arraySize; elementIndex++) {
             auto elementValue = array->values[elementIndex].clone();
             if (elementValue.isError()) {
@@ -2443,7 +3124,7 @@ Value Value::clone() {
         }
         return resultArrayValue;
     } else if (isString()) {
-        return makeStringRef(getString(), -1, 0x91846ff3);
+        return makeStringRef(getString(), getStringLength(), 0x91846ff3);
     }
     return *this;
 }
@@ -2495,6 +3176,598 @@ void setVar(int16_t id, const Value& value) {
     }
 }
 } 
+namespace eez {
+static const int JSON_MAX_DEPTH = 64;
+struct JsonParser {
+    char *text;
+    uint32_t len;
+    uint32_t pos;
+    JsonNode *nodes;
+    uint32_t numNodes;
+    uint32_t capacity;
+    uint32_t id;
+};
+static void skipJsonWhitespace(JsonParser &parser) {
+    while (parser.pos < parser.len) {
+        char c = parser.text[parser.pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        parser.pos++;
+    }
+}
+static int addJsonNode(JsonParser &parser, JsonNodeType type, uint32_t offset) {
+    if (parser.numNodes == parser.capacity) {
+        uint32_t capacity = parser.capacity * 2;
+        auto nodes = (JsonNode *)alloc(capacity * sizeof(JsonNode), parser.id + 1);
+        if (!nodes) {
+            return -1;
+        }
+        memcpy(nodes, parser.nodes, parser.numNodes * sizeof(JsonNode));
+        eez::free(parser.nodes);
+        parser.nodes = nodes;
+        parser.capacity = capacity;
+    }
+    auto &node = parser.nodes[parser.numNodes];
+    node.type = type;
+    node.offset = offset;
+    node.next = parser.numNodes + 1;
+    node.size = 0;
+    return parser.numNodes++;
+}
+static int parseHex4(const char *str) {
+    int result = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = str[i];
+        result <<= 4;
+        if (c >= '0' && c <= '9') {
+            result |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            result |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            result |= c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return result;
+}
+static char *writeUtf8(char *dst, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        *dst++ = (char)codePoint;
+    } else if (codePoint < 0x800) {
+        *dst++ = (char)(0xC0 | (codePoint >> 6));
+        *dst++ = (char)(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        *dst++ = (char)(0xE0 | (codePoint >> 12));
+        *dst++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *dst++ = (char)(0x80 | (codePoint & 0x3F));
+    } else {
+        *dst++ = (char)(0xF0 | (codePoint >> 18));
+        *dst++ = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        *dst++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *dst++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    return dst;
+}
+static bool parseJsonString(JsonParser &parser) {
+    uint32_t start = parser.pos + 1;
+    int nodeIndex = addJsonNode(parser, JSON_NODE_STRING, start);
+    if (nodeIndex < 0) {
+        return false;
+    }
+    char *text = parser.text;
+    uint32_t src = start;
+    uint32_t dst = start;
+    while (true) {
+        if (src >= parser.len) {
+            return false;
+        }
+        char c = text[src];
+        if (c == '"') {
+            break;
+        }
+        if ((uint8_t)c < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            text[dst++] = c;
+            src++;
+            continue;
+        }
+        if (src + 1 >= parser.len) {
+            return false;
+        }
+        c = text[src + 1];
+        src += 2;
+        switch (c) {
+        case '"': text[dst++] = '"'; break;
+        case '\\': text[dst++] = '\\'; break;
+        case '/': text[dst++] = '/'; break;
+        case 'b': text[dst++] = '\b'; break;
+        case 'f': text[dst++] = '\f'; break;
+        case 'n': text[dst++] = '\n'; break;
+        case 'r': text[dst++] = '\r'; break;
+        case 't': text[dst++] = '\t'; break;
+        case 'u': {
+            if (src + 4 > parser.len) {
+                return false;
+            }
+            int codePoint = parseHex4(text + src);
+            if (codePoint < 0) {
+                return false;
+            }
+            src += 4;
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && src + 6 <= parser.len && text[src] == '\\' && text[src + 1] == 'u') {
+                int lowSurrogate = parseHex4(text + src + 2);
+                if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    src += 6;
+                }
+            }
+            dst = writeUtf8(text + dst, codePoint) - text;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    text[dst] = 0;
+    parser.nodes[nodeIndex].size = dst - start;
+    parser.pos = src + 1;
+    return true;
+}
+static bool parseJsonLiteral(JsonParser &parser, const char *literal, JsonNodeType type) {
+    uint32_t literalLen = strlen(literal);
+    if (parser.pos + literalLen > parser.len || memcmp(parser.text + parser.pos, literal, literalLen) != 0) {
+        return false;
+    }
+    if (addJsonNode(parser, type, parser.pos) < 0) {
+        return false;
+    }
+    parser.pos += literalLen;
+    return true;
+}
+static bool isJsonDigit(const JsonParser &parser) {
+    return parser.pos < parser.len && parser.text[parser.pos] >= '0' && parser.text[parser.pos] <= '9';
+}
+static bool skipJsonDigits(JsonParser &parser) {
+    if (!isJsonDigit(parser)) {
+        return false;
+    }
+    while (isJsonDigit(parser)) {
+        parser.pos++;
+    }
+    return true;
+}
+static bool parseJsonNumber(JsonParser &parser) {
+    uint32_t start = parser.pos;
+    if (parser.text[parser.pos] == '-') {
+        parser.pos++;
+    }
+    if (parser.pos < parser.len && parser.text[parser.pos] == '0') {
+        parser.pos++;
+    } else if (!skipJsonDigits(parser)) {
+        return false;
+    }
+    if (parser.pos < parser.len && parser.text[parser.pos] == '.') {
+        parser.pos++;
+        if (!skipJsonDigits(parser)) {
+            return false;
+        }
+    }
+    if (parser.pos < parser.len && (parser.text[parser.pos] == 'e' || parser.text[parser.pos] == 'E')) {
+        parser.pos++;
+        if (parser.pos < parser.len && (parser.text[parser.pos] == '+' || parser.text[parser.pos] == '-')) {
+            parser.pos++;
+        }
+        if (!skipJsonDigits(parser)) {
+            return false;
+        }
+    }
+    int nodeIndex = addJsonNode(parser, JSON_NODE_NUMBER, start);
+    if (nodeIndex < 0) {
+        return false;
+    }
+    parser.nodes[nodeIndex].size = parser.pos - start;
+    return true;
+}
+static bool parseJsonValue(JsonParser &parser, int depth) {
+    if (depth > JSON_MAX_DEPTH) {
+        return false;
+    }
+    skipJsonWhitespace(parser);
+    if (parser.pos >= parser.len) {
+        return false;
+    }
+    char c = parser.text[parser.pos];
+    if (c == '{' || c == '[') {
+        bool isObject = c == '{';
+        char closeChar = isObject ? '}' : ']';
+        int nodeIndex = addJsonNode(parser, isObject ? JSON_NODE_OBJECT : JSON_NODE_ARRAY, parser.pos);
+        if (nodeIndex < 0) {
+            return false;
+        }
+        parser.pos++;
+        skipJsonWhitespace(parser);
+        if (parser.pos < parser.len && parser.text[parser.pos] == closeChar) {
+            parser.pos++;
+        } else {
+            while (true) {
+                if (isObject) {
+                    skipJsonWhitespace(parser);
+                    if (parser.pos >= parser.len || parser.text[parser.pos] != '"' || !parseJsonString(parser)) {
+                        return false;
+                    }
+                    skipJsonWhitespace(parser);
+                    if (parser.pos >= parser.len || parser.text[parser.pos] != ':') {
+                        return false;
+                    }
+                    parser.pos++;
+                }
+                if (!parseJsonValue(parser, depth + 1)) {
+                    return false;
+                }
+                parser.nodes[nodeIndex].size++;
+                skipJsonWhitespace(parser);
+                if (parser.pos >= parser.len) {
+                    return false;
+                }
+                c = parser.text[parser.pos++];
+                if (c == closeChar) {
+                    break;
+                }
+                if (c != ',') {
+                    return false;
+                }
+            }
+        }
+        parser.nodes[nodeIndex].next = parser.numNodes;
+        return true;
+    }
+    if (c == '"') {
+        return parseJsonString(parser);
+    }
+    if (c == 't') {
+        return parseJsonLiteral(parser, "true", JSON_NODE_TRUE);
+    }
+    if (c == 'f') {
+        return parseJsonLiteral(parser, "false", JSON_NODE_FALSE);
+    }
+    if (c == 'n') {
+        return parseJsonLiteral(parser, "null", JSON_NODE_NULL);
+    }
+    return parseJsonNumber(parser);
+}
+static Value makeJsonNodeValue(const Value &jsonValue, uint32_t nodeIndex) {
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    auto &node = jsonRef->nodes[nodeIndex];
+    if (node.type == JSON_NODE_NULL) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    if (node.type == JSON_NODE_FALSE || node.type == JSON_NODE_TRUE) {
+        return Value(node.type == JSON_NODE_TRUE, VALUE_TYPE_BOOLEAN);
+    }
+    const char *text = jsonRef->text.getString();
+    if (node.type == JSON_NODE_NUMBER) {
+        const char *str = text + node.offset;
+        bool isInteger = true;
+        for (uint32_t i = 0; i < node.size; i++) {
+            if (str[i] == '.' || str[i] == 'e' || str[i] == 'E') {
+                isInteger = false;
+                break;
+            }
+        }
+        if (isInteger && node.size < 10) {
+            return Value((int)strtol(str, nullptr, 10), VALUE_TYPE_INT32);
+        }
+        return Value(strtod(str, nullptr), VALUE_TYPE_DOUBLE);
+    }
+    if (node.type == JSON_NODE_STRING) {
+        if (jsonRef->text.type != VALUE_TYPE_STRING_REF || node.size < sizeof(StringSliceRef)) {
+            return Value::makeStringRef(text + node.offset, node.size, 0x5d3a9e07);
+        }
+        return Value::makeStringSliceRef(jsonRef->text, text + node.offset, node.size, 0x5d3a9e07);
+    }
+    if (nodeIndex == jsonRef->nodeIndex) {
+        return jsonValue;
+    }
+    auto nodeRef = ObjectAllocator<JsonRef>::allocate(0x2c7b4e1d);
+    if (!nodeRef) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    nodeRef->refCounter = 1;
+    nodeRef->text = jsonRef->text;
+    nodeRef->nodes = jsonRef->nodes;
+    nodeRef->numNodes = jsonRef->numNodes;
+    nodeRef->nodeIndex = nodeIndex;
+    nodeRef->documentValue = jsonRef->documentValue.isJson() ? jsonRef->documentValue : jsonValue;
+    Value value;
+    value.type = VALUE_TYPE_JSON;
+    value.options = VALUE_OPTIONS_REF;
+    value.refValue = nodeRef;
+    return value;
+}
+Value Value::makeJsonRef(const char *json, int len, uint32_t id) {
+    if (len == -1) {
+        len = strlen(json);
+    }
+    JsonParser parser;
+    parser.capacity = len / 8 + 8;
+    parser.nodes = (JsonNode *)alloc(parser.capacity * sizeof(JsonNode), id + 1);
+    if (!parser.nodes) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    auto jsonRef = ObjectAllocator<JsonRef>::allocate(id);
+    if (!jsonRef) {
+        eez::free(parser.nodes);
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    jsonRef->refCounter = 1;
+    jsonRef->nodes = parser.nodes;
+    jsonRef->numNodes = 0;
+    jsonRef->nodeIndex = 0;
+    Value value;
+    value.type = VALUE_TYPE_JSON;
+    value.options = VALUE_OPTIONS_REF;
+    value.refValue = jsonRef;
+    jsonRef->text = makeStringRef(json, len, id + 2);
+    parser.text = (char *)jsonRef->text.getString();
+    if (!parser.text) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    parser.len = len;
+    parser.pos = 0;
+    parser.numNodes = 0;
+    parser.id = id;
+    bool result = parseJsonValue(parser, 0);
+    jsonRef->nodes = parser.nodes;
+    jsonRef->numNodes = parser.numNodes;
+    if (result) {
+        skipJsonWhitespace(parser);
+        result = parser.pos == parser.len;
+    }
+    if (!result) {
+        return Value::makeError();
+    }
+    if (jsonRef->nodes[0].type != JSON_NODE_OBJECT && jsonRef->nodes[0].type != JSON_NODE_ARRAY) {
+        return makeJsonNodeValue(value, 0);
+    }
+    return value;
+}
+bool isJsonRef(const Value &jsonValue) {
+    return jsonValue.type == VALUE_TYPE_JSON && (jsonValue.options & VALUE_OPTIONS_REF);
+}
+static const JsonNode &getJsonNode(const Value &jsonValue) {
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    return jsonRef->nodes[jsonRef->nodeIndex];
+}
+bool isSameJsonNode(const Value &a, const Value &b) {
+    return isJsonRef(a) && isJsonRef(b) && &getJsonNode(a) == &getJsonNode(b);
+}
+Value getJsonMember(const Value &jsonValue, const char *name, int nameLen) {
+    if (!isJsonRef(jsonValue)) {
+        return Value();
+    }
+    if (nameLen == -1) {
+        nameLen = strlen(name);
+    }
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    auto nodes = jsonRef->nodes;
+    uint32_t nodeIndex = jsonRef->nodeIndex;
+    if (nodes[nodeIndex].type != JSON_NODE_OBJECT) {
+        return Value();
+    }
+    const char *text = jsonRef->text.getString();
+    uint32_t keyIndex = nodeIndex + 1;
+    for (uint32_t i = 0; i < nodes[nodeIndex].size; i++) {
+        uint32_t valueIndex = keyIndex + 1;
+        if (nodes[keyIndex].size == (uint32_t)nameLen && memcmp(text + nodes[keyIndex].offset, name, nameLen) == 0) {
+            return makeJsonNodeValue(jsonValue, valueIndex);
+        }
+        keyIndex = nodes[valueIndex].next;
+    }
+    return Value();
+}
+Value getJsonElement(const Value &jsonValue, int elementIndex) {
+    if (!isJsonRef(jsonValue)) {
+        return Value();
+    }
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    auto nodes = jsonRef->nodes;
+    uint32_t nodeIndex = jsonRef->nodeIndex;
+    if (nodes[nodeIndex].type != JSON_NODE_ARRAY || elementIndex < 0 || (uint32_t)elementIndex >= nodes[nodeIndex].size) {
+        return Value();
+    }
+    uint32_t childIndex = nodeIndex + 1;
+    for (int i = 0; i < elementIndex; i++) {
+        childIndex = nodes[childIndex].next;
+    }
+    return makeJsonNodeValue(jsonValue, childIndex);
+}
+static bool parseJsonIndex(const char *str, int len, int &index) {
+    if (len == 0 || len > 9) {
+        return false;
+    }
+    index = 0;
+    for (int i = 0; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return false;
+        }
+        index = index * 10 + (str[i] - '0');
+    }
+    return true;
+}
+static Value getJsonSegment(const Value &jsonValue, const char *segment, int segmentLen) {
+    int elementIndex;
+    if (isJsonRef(jsonValue) && getJsonNode(jsonValue).type == JSON_NODE_ARRAY && parseJsonIndex(segment, segmentLen, elementIndex)) {
+        return getJsonElement(jsonValue, elementIndex);
+    }
+    return getJsonMember(jsonValue, segment, segmentLen);
+}
+Value getJsonProperty(const Value &jsonValue, const Value &propertyValue) {
+    if (propertyValue.isString()) {
+        const char *name = propertyValue.getString();
+        return getJsonSegment(jsonValue, name, strlen(name));
+    }
+    int err;
+    int elementIndex = propertyValue.toInt32(&err);
+    if (err) {
+        return Value();
+    }
+    return getJsonElement(jsonValue, elementIndex);
+}
+Value getJsonPath(const Value &jsonValue, const char *path) {
+    Value value = jsonValue;
+    const char *p = path;
+    while (*p) {
+        const char *segment;
+        int segmentLen;
+        if (*p == '[') {
+            segment = ++p;
+            while (*p && *p != ']') {
+                p++;
+            }
+            segmentLen = p - segment;
+            if (*p == ']') {
+                p++;
+            }
+        } else {
+            segment = p;
+            while (*p && *p != '.' && *p != '[') {
+                p++;
+            }
+            segmentLen = p - segment;
+        }
+        if (*p == '.') {
+            p++;
+        }
+        if (segmentLen == 0) {
+            continue;
+        }
+        value = getJsonSegment(value, segment, segmentLen);
+        if (!isJsonRef(value)) {
+            return *p ? Value() : value;
+        }
+    }
+    return value;
+}
+bool getJsonLength(const Value &jsonValue, uint32_t &length) {
+    if (!isJsonRef(jsonValue)) {
+        return false;
+    }
+    auto &node = getJsonNode(jsonValue);
+    if (node.type != JSON_NODE_ARRAY) {
+        return false;
+    }
+    length = node.size;
+    return true;
+}
+struct JsonWriter {
+    char *text;
+    int count;
+    int pos;
+    void write(char c) {
+        if (pos < count - 1) {
+            if (text) {
+                text[pos] = c;
+            }
+            pos++;
+        }
+    }
+    void write(const char *str, int len) {
+        for (int i = 0; i < len; i++) {
+            write(str[i]);
+        }
+    }
+};
+static void writeJsonString(JsonWriter &writer, const char *str, uint32_t len) {
+    writer.write('"');
+    for (uint32_t i = 0; i < len; i++) {
+        char c = str[i];
+        if (c == '"' || c == '\\') {
+            writer.write('\\');
+            writer.write(c);
+        } else if ((uint8_t)c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", (unsigned)(uint8_t)c);
+            writer.write(escape, 6);
+        } else {
+            writer.write(c);
+        }
+    }
+    writer.write('"');
+}
+static uint32_t writeJsonNode(JsonWriter &writer, const JsonRef *jsonRef, uint32_t nodeIndex) {
+    auto &node = jsonRef->nodes[nodeIndex];
+    const char *text = jsonRef->text.getString();
+    switch (node.type) {
+    case JSON_NODE_NULL: writer.write("null", 4); break;
+    case JSON_NODE_FALSE: writer.write("false", 5); break;
+    case JSON_NODE_TRUE: writer.write("true", 4); break;
+    case JSON_NODE_NUMBER: writer.write(text + node.offset, node.size); break;
+    case JSON_NODE_STRING: writeJsonString(writer, text + node.offset, node.size); break;
+    default: {
+        bool isObject = node.type == JSON_NODE_OBJECT;
+        writer.write(isObject ? '{' : '[');
+        uint32_t childIndex = nodeIndex + 1;
+        for (uint32_t i = 0; i < node.size && writer.pos < writer.count - 1; i++) {
+            if (i > 0) {
+                writer.write(',');
+            }
+            if (isObject) {
+                childIndex = writeJsonNode(writer, jsonRef, childIndex);
+                writer.write(':');
+            }
+            childIndex = writeJsonNode(writer, jsonRef, childIndex);
+        }
+        writer.write(isObject ? '}' : ']');
+    }
+    }
+    return node.next;
+}
+void jsonToText(const Value &jsonValue, char *text, int count) {
+    if (count <= 0) {
+        return;
+    }
+    JsonWriter writer;
+    writer.text = text;
+    writer.count = count;
+    writer.pos = 0;
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    writeJsonNode(writer, jsonRef, jsonRef->nodeIndex);
+    text[writer.pos] = 0;
+}
+uint32_t getJsonTextLength(const Value &jsonValue) {
+    JsonWriter writer;
+    writer.text = nullptr;
+    writer.count = INT32_MAX;
+    writer.pos = 0;
+    auto jsonRef = (JsonRef *)jsonValue.refValue;
+    writeJsonNode(writer, jsonRef, jsonRef->nodeIndex);
+    return writer.pos;
+}
+Value parseJsonString(const Value &stringValue) {
+    if (stringValue.type != VALUE_TYPE_STRING_REF) {
+        return Value::makeJsonRef(stringValue.getString(), stringValue.getStringLength(), 0x8f2e6b51);
+    }
+    auto stringRef = (StringRef *)stringValue.refValue;
+    Value jsonValue;
+    if (stringRef->jsonRef) {
+        jsonValue.type = VALUE_TYPE_JSON;
+        jsonValue.options = VALUE_OPTIONS_REF;
+        jsonValue.refValue = stringRef->jsonRef;
+        stringRef->jsonRef->refCounter++;
+        return jsonValue;
+    }
+    jsonValue = Value::makeJsonRef(stringRef->str, stringRef->len, 0x8f2e6b51);
+    if (isJsonRef(jsonValue)) {
+        stringRef->jsonRef = jsonValue.refValue;
+        stringRef->jsonRef->refCounter++;
+    }
+    return jsonValue;
+}
+} 
 // -----------------------------------------------------------------------------
 // flow/components.cpp
 // -----------------------------------------------------------------------------
@@ -2852,15 +4125,15 @@ void executeDelayComponent(FlowState *flowState, unsigned componentIndex) {
 			throwError(flowState, componentIndex, FlowError::PropertyInvalid("Delay", "Milliseconds"));
 			return;
 		}
-		if (!addToQueue(flowState, componentIndex, -1, -1, -1, true)) {
+		if (!addTimer(flowState, componentIndex, delayComponentExecutionState->waitUntil)) {
 			return;
 		}
 	} else {
-		if (millis() >= delayComponentExecutionState->waitUntil) {
+		if ((int32_t)(millis() - delayComponentExecutionState->waitUntil) >= 0) {
 			deallocateComponentExecutionState(flowState, componentIndex);
 			propagateValueThroughSeqout(flowState, componentIndex);
 		} else {
-			if (!addToQueue(flowState, componentIndex, -1, -1, -1, true)) {
+			if (!addTimer(flowState, componentIndex, delayComponentExecutionState->waitUntil)) {
 				return;
 			}
 		}
@@ -3265,7 +4538,8 @@ void executeLVGLComponent(FlowState *flowState, unsigned componentIndex) {
                     return;
                 }
                 if (specific->property == IMAGE_IMAGE || specific->property == LABEL_TEXT) {
-                    const char *strValue = value.toString(0xe42b3ca2).getString();
+                    Value strValueValue = value.toString(0xe42b3ca2);
+                    const char *strValue = strValueValue.getString();
                     if (specific->property == IMAGE_IMAGE) {
                         const void *src = getLvglImageByNameHook(strValue);
                         if (src) {
@@ -3537,7 +4811,8 @@ const char *getFullObjectName(FlowState *flowState, const char *objectName) {
         return; \
     }\
     propIndex++; \
-    const char *NAME = NAME##Value.toString(0xe42b3ca2).getString();
+    NAME##Value = NAME##Value.toString(0xe42b3ca2); \
+    const char *NAME = NAME##Value.getString();
 #define SCREEN_PROP(NAME) \
     Value NAME##Value; \
     if (!evalExpression(flowState, componentIndex, properties[propIndex]->evalInstructions, NAME##Value, FlowError::PropertyInAction(#NAME, actionName, actionIndex))) { \
@@ -4840,8 +6115,15 @@ void executeSetVariableComponent(FlowState *flowState, unsigned componentIndex)
         if (!evalAssignableExpression(flowState, componentIndex, entry->variable, dstValue, FlowError::PropertyInArray("SetVariable", "Variable", entryIndex))) {
             return;
         }
+        Value *inPlaceAssignmentTarget = nullptr;
+        if (dstValue.getType() == VALUE_TYPE_VALUE_PTR) {
+            inPlaceAssignmentTarget = dstValue.pValueValue;
+            while (inPlaceAssignmentTarget->type == VALUE_TYPE_VALUE_PTR) {
+                inPlaceAssignmentTarget = inPlaceAssignmentTarget->pValueValue;
+            }
+        }
         Value srcValue;
-        if (!evalExpression(flowState, componentIndex, entry->value, srcValue, FlowError::PropertyInArray("SetVariable", "Value", entryIndex))) {
+        if (!evalExpression(flowState, componentIndex, entry->value, srcValue, FlowError::PropertyInArray("SetVariable", "Value", entryIndex), nullptr, nullptr, inPlaceAssignmentTarget)) {
             return;
         }
         assignValue(flowState, componentIndex, dstValue, srcValue);
@@ -4872,56 +6154,259 @@ void executeShowPageComponent(FlowState *flowState, unsigned componentIndex) {
 #include <stdlib.h>
 namespace eez {
 namespace flow {
-SortArrayActionComponent *g_sortArrayActionComponent;
-static int elementCompare(const void *a, const void *b) {
-    auto aValue = *(const Value *)a;
-    auto bValue = *(const Value *)b;
-    if (g_sortArrayActionComponent->arrayType != -1) {
-        if (!aValue.isArray()) {
-            return 0;
+struct SortArrayItem {
+    union {
+        double numberKey;
+        const char *stringKey;
+        const Value *valueKey;
+    };
+    uint32_t rowIndex;
+    uint32_t integerKey;
+};
+enum SortArrayKeyKind {
+    SORT_ARRAY_KEY_INTEGER,
+    SORT_ARRAY_KEY_NUMBER,
+    SORT_ARRAY_KEY_STRING,
+    SORT_ARRAY_KEY_MIXED
+};
+template <typename Less>
+static void mergeSortItems(SortArrayItem *items, SortArrayItem *temp, uint32_t n, Less less) {
+    static const uint32_t RUN_SIZE = 16;
+    for (uint32_t runStart = 0; runStart < n; runStart += RUN_SIZE) {
+        uint32_t runEnd = runStart + RUN_SIZE < n ? runStart + RUN_SIZE : n;
+        for (uint32_t i = runStart + 1; i < runEnd; i++) {
+            SortArrayItem item = items[i];
+            uint32_t j = i;
+            while (j > runStart && less(item, items[j - 1])) {
+                items[j] = items[j - 1];
+                j--;
+            }
+            items[j] = item;
+        }
+    }
+    SortArrayItem *src = items;
+    SortArrayItem *dst = temp;
+    for (uint32_t width = RUN_SIZE; width < n; width *= 2) {
+        for (uint32_t left = 0; left < n; left += 2 * width) {
+            uint32_t mid = left + width < n ? left + width : n;
+            uint32_t right = left + 2 * width < n ? left + 2 * width : n;
+            uint32_t i = left;
+            uint32_t j = mid;
+            uint32_t k = left;
+            while (i < mid && j < right) {
+                dst[k++] = less(src[j], src[i]) ? src[j++] : src[i++];
+            }
+            while (i < mid) {
+                dst[k++] = src[i++];
+            }
+            while (j < right) {
+                dst[k++] = src[j++];
+            }
+        }
+        SortArrayItem *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != items) {
+        memcpy(items, src, n * sizeof(SortArrayItem));
+    }
+}
+static void radixSortItems(SortArrayItem *items, SortArrayItem *temp, uint32_t n) {
+    if (n < 2) {
+        return;
+    }
+    SortArrayItem *src = items;
+    SortArrayItem *dst = temp;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t counts[256] = { 0 };
+        for (uint32_t i = 0; i < n; i++) {
+            counts[(src[i].integerKey >> shift) & 0xFF]++;
+        }
+        if (counts[(src[0].integerKey >> shift) & 0xFF] == n) {
+            continue;
         }
-        auto aArray = aValue.getArray();
-        if ((uint32_t)g_sortArrayActionComponent->structFieldIndex >= aArray->arraySize) {
-            return 0;
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            uint32_t count = counts[digit];
+            counts[digit] = offset;
+            offset += count;
         }
-        aValue = aArray->values[g_sortArrayActionComponent->structFieldIndex];
-        if (!bValue.isArray()) {
-            return 0;
+        for (uint32_t i = 0; i < n; i++) {
+            dst[counts[(src[i].integerKey >> shift) & 0xFF]++] = src[i];
         }
-        auto bArray = bValue.getArray();
-        if ((uint32_t)g_sortArrayActionComponent->structFieldIndex >= bArray->arraySize) {
-            return 0;
+        SortArrayItem *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != items) {
+        memcpy(items, src, n * sizeof(SortArrayItem));
+    }
+}
+static uint32_t foldSortKey(const char *str, char *dst) {
+    uint32_t size = 0;
+#if UTF8_SUPPORT
+    while (true) {
+        utf8_int32_t cp;
+        str = utf8codepoint(str, &cp);
+        if (!cp) {
+            break;
+        }
+        cp = utf8lwrcodepoint(cp);
+        auto cpSize = utf8codepointsize(cp);
+        if (dst) {
+            utf8catcodepoint(dst + size, cp, cpSize);
+        }
+        size += cpSize;
+    }
+#else
+    for (; *str; str++, size++) {
+        if (dst) {
+            dst[size] = (char)tolower((uint8_t)*str);
         }
-        bValue = bArray->values[g_sortArrayActionComponent->structFieldIndex];
     }
-    int result;
+#endif
+    if (dst) {
+        dst[size] = 0;
+    }
+    return size + 1;
+}
+static int compareMixedSortKeys(const Value &aValue, const Value &bValue, bool ignoreCase) {
     if (aValue.isString() && bValue.isString()) {
-        if (g_sortArrayActionComponent->flags & SORT_ARRAY_FLAG_IGNORE_CASE) {
-            result = utf8casecmp(aValue.getString(), bValue.getString());
+        return ignoreCase ? utf8casecmp(aValue.getString(), bValue.getString()) : utf8cmp(aValue.getString(), bValue.getString());
+    }
+    int err;
+    double aDouble = aValue.toDouble(&err);
+    if (err) {
+        return 0;
+    }
+    double bDouble = bValue.toDouble(&err);
+    if (err) {
+        return 0;
+    }
+    return aDouble < bDouble ? -1 : aDouble > bDouble ? 1 : 0;
+}
+static const Value *getSortKeyValue(SortArrayActionComponent *component, const ArrayValue *array, uint32_t rowIndex) {
+    if (component->arrayType != -1) {
+        return getStructFieldValue(array->values[rowIndex], component->structFieldIndex);
+    }
+    return &array->values[rowIndex];
+}
+bool sortArray(SortArrayActionComponent *component, ArrayValue *array) {
+    uint32_t n = array->arraySize;
+    if (n < 2) {
+        return true;
+    }
+    auto items = (SortArrayItem *)alloc(n * sizeof(SortArrayItem), 0x3b8e6d21);
+    if (!items) {
+        return false;
+    }
+    auto temp = (SortArrayItem *)alloc(n * (sizeof(SortArrayItem) > sizeof(Value) ? sizeof(SortArrayItem) : sizeof(Value)), 0x7c1f94a2);
+    if (!temp) {
+        free(items);
+        return false;
+    }
+    bool ascending = (component->flags & SORT_ARRAY_FLAG_ASCENDING) != 0;
+    bool ignoreCase = (component->flags & SORT_ARRAY_FLAG_IGNORE_CASE) != 0;
+    uint32_t numKeys = 0;
+    uint32_t numInvalidKeys = 0;
+    bool hasIntegerKeys = false;
+    bool hasNumberKeys = false;
+    bool hasStringKeys = false;
+    uint32_t foldedKeysSize = 0;
+    for (uint32_t rowIndex = 0; rowIndex < n; rowIndex++) {
+        auto keyValue = getSortKeyValue(component, array, rowIndex);
+        if (keyValue && keyValue->isString()) {
+            hasStringKeys = true;
+            if (ignoreCase) {
+                foldedKeysSize += foldSortKey(keyValue->getString(), nullptr);
+            }
         } else {
-            result = utf8cmp(aValue.getString(), bValue.getString());
+            int err = 1;
+            if (keyValue) {
+                keyValue->toDouble(&err);
+            }
+            if (err) {
+                temp[numInvalidKeys++].rowIndex = rowIndex;
+                continue;
+            }
+            if (keyValue->isInt32OrLess() && keyValue->type != VALUE_TYPE_UINT32) {
+                hasIntegerKeys = true;
+            } else {
+                hasNumberKeys = true;
+            }
         }
-    } else {
-        int err;
-        float aDouble = aValue.toDouble(&err);
-        if (err) {
-            return 0;
+        items[numKeys].valueKey = keyValue;
+        items[numKeys].rowIndex = rowIndex;
+        numKeys++;
+    }
+    SortArrayKeyKind keyKind =
+        hasStringKeys ? (hasIntegerKeys || hasNumberKeys ? SORT_ARRAY_KEY_MIXED : SORT_ARRAY_KEY_STRING) :
+        hasNumberKeys ? SORT_ARRAY_KEY_NUMBER : SORT_ARRAY_KEY_INTEGER;
+    char *foldedKeys = nullptr;
+    if (keyKind == SORT_ARRAY_KEY_STRING && ignoreCase) {
+        foldedKeys = (char *)alloc(foldedKeysSize, 0x52c7a0e3);
+        if (!foldedKeys) {
+            keyKind = SORT_ARRAY_KEY_MIXED;
         }
-        float bDouble = bValue.toDouble(&err);
-        if (err) {
-            return 0;
+    }
+    if (keyKind == SORT_ARRAY_KEY_INTEGER) {
+        for (uint32_t i = 0; i < numKeys; i++) {
+            uint32_t key = (uint32_t)items[i].valueKey->toInt32() ^ 0x80000000u;
+            items[i].integerKey = ascending ? key : ~key;
+        }
+        radixSortItems(items, temp + numInvalidKeys, numKeys);
+    } else if (keyKind == SORT_ARRAY_KEY_NUMBER) {
+        for (uint32_t i = 0; i < numKeys; i++) {
+            items[i].numberKey = items[i].valueKey->toDouble();
+        }
+        if (ascending) {
+            mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return a.numberKey < b.numberKey; });
+        } else {
+            mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return b.numberKey < a.numberKey; });
+        }
+    } else if (keyKind == SORT_ARRAY_KEY_STRING) {
+        if (foldedKeys) {
+            char *dst = foldedKeys;
+            for (uint32_t i = 0; i < numKeys; i++) {
+                auto foldedKeySize = foldSortKey(items[i].valueKey->getString(), dst);
+                items[i].stringKey = dst;
+                dst += foldedKeySize;
+            }
+            if (ascending) {
+                mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return strcmp(a.stringKey, b.stringKey) < 0; });
+            } else {
+                mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return strcmp(b.stringKey, a.stringKey) < 0; });
+            }
+        } else {
+            for (uint32_t i = 0; i < numKeys; i++) {
+                items[i].stringKey = items[i].valueKey->getString();
+            }
+            if (ascending) {
+                mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return utf8cmp(a.stringKey, b.stringKey) < 0; });
+            } else {
+                mergeSortItems(items, temp + numInvalidKeys, numKeys, [](const SortArrayItem &a, const SortArrayItem &b) { return utf8cmp(b.stringKey, a.stringKey) < 0; });
+            }
         }
-        auto diff = aDouble - bDouble;
-        result = diff < 0 ? -1 : diff > 0 ? 1 : 0;
+    } else {
+        mergeSortItems(items, temp + numInvalidKeys, numKeys, [ascending, ignoreCase](const SortArrayItem &a, const SortArrayItem &b) {
+            int result = compareMixedSortKeys(*a.valueKey, *b.valueKey, ignoreCase);
+            return ascending ? result < 0 : result > 0;
+        });
     }
-    if (!(g_sortArrayActionComponent->flags & SORT_ARRAY_FLAG_ASCENDING)) {
-        result = -result;
+    if (foldedKeys) {
+        free(foldedKeys);
     }
-    return result;
-}
-void sortArray(SortArrayActionComponent *component, ArrayValue *array) {
-    g_sortArrayActionComponent = component;
-    qsort(&array->values[0], array->arraySize, sizeof(Value), elementCompare);
+    for (uint32_t i = 0; i < numInvalidKeys; i++) {
+        items[numKeys + i].rowIndex = temp[i].rowIndex;
+    }
+    auto sortedValues = (Value *)temp;
+    for (uint32_t i = 0; i < n; i++) {
+        memcpy((void *)(sortedValues + i), (const void *)(array->values + items[i].rowIndex), sizeof(Value));
+    }
+    memcpy((void *)array->values, (const void *)sortedValues, n * sizeof(Value));
+    free(temp);
+    free(items);
+    return true;
 }
 void executeSortArrayComponent(FlowState *flowState, unsigned componentIndex) {
     auto component = (SortArrayActionComponent *)flowState->flow->components[componentIndex];
@@ -4942,6 +6427,7 @@ void executeSortArrayComponent(FlowState *flowState, unsigned componentIndex) {
         }
         if (component->structFieldIndex < 0) {
             throwError(flowState, componentIndex, FlowError::Plain("SortArray: invalid struct field index\n"));
+            return;
         }
     } else {
         if (array->arrayType != defs_v3::ARRAY_TYPE_INTEGER && array->arrayType != defs_v3::ARRAY_TYPE_FLOAT && array->arrayType != defs_v3::ARRAY_TYPE_DOUBLE && array->arrayType != defs_v3::ARRAY_TYPE_STRING) {
@@ -4949,7 +6435,10 @@ void executeSortArrayComponent(FlowState *flowState, unsigned componentIndex) {
             return;
         }
     }
-    sortArray(component, array);
+    if (!sortArray(component, array)) {
+        throwError(flowState, componentIndex, FlowError::Plain("SortArray: out of memory\n"));
+        return;
+    }
 	propagateValue(flowState, componentIndex, component->outputs.count - 1, arrayValue);
 }
 } 
@@ -5033,15 +6522,20 @@ struct WatchVariableComponenentExecutionState : public ComponenentExecutionState
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex) {
 	auto watchVariableComponentExecutionState = (WatchVariableComponenentExecutionState *)flowState->componenentExecutionStates[componentIndex];
     Value value;
+    beginRecordingWatchDependencies();
     if (!evalProperty(flowState, componentIndex, defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE, value, FlowError::Property("WatchVariable", "Variable"))) {
+        recordUntrackedWatchDependency();
+        endRecordingWatchDependencies(watchVariableComponentExecutionState ? watchVariableComponentExecutionState->node : nullptr);
         return;
     }
 	if (!watchVariableComponentExecutionState) {
         watchVariableComponentExecutionState = allocateComponentExecutionState<WatchVariableComponenentExecutionState>(flowState, componentIndex);
         watchVariableComponentExecutionState->value = value.type == VALUE_TYPE_STRING ? value.clone() : value;
         watchVariableComponentExecutionState->node = watchListAdd(flowState, componentIndex);
+        endRecordingWatchDependencies(watchVariableComponentExecutionState->node);
         propagateValue(flowState, componentIndex, 1, value);
 	} else {
+        endRecordingWatchDependencies(watchVariableComponentExecutionState->node);
 		if (value != watchVariableComponentExecutionState->value) {
             watchVariableComponentExecutionState->value = value.type == VALUE_TYPE_STRING ? value.clone() : value;
 			propagateValue(flowState, componentIndex, 1, value);
@@ -5308,7 +6802,8 @@ enum MessagesToDebugger {
     MESSAGE_TO_DEBUGGER_LOG, 
 	MESSAGE_TO_DEBUGGER_PAGE_CHANGED, 
     MESSAGE_TO_DEBUGGER_COMPONENT_EXECUTION_STATE_CHANGED, 
-    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED 
+    MESSAGE_TO_DEBUGGER_COMPONENT_ASYNC_STATE_CHANGED, 
+    MESSAGE_TO_DEBUGGER_ALLOC_STATS 
 };
 enum MessagesFromDebugger {
     MESSAGE_FROM_DEBUGGER_RESUME, 
@@ -5318,7 +6813,8 @@ enum MessagesFromDebugger {
     MESSAGE_FROM_DEBUGGER_REMOVE_BREAKPOINT, 
     MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT, 
     MESSAGE_FROM_DEBUGGER_DISABLE_BREAKPOINT, 
-    MESSAGE_FROM_DEBUGGER_MODE 
+    MESSAGE_FROM_DEBUGGER_MODE, 
+    MESSAGE_FROM_DEBUGGER_GET_ALLOC_STATS 
 };
 enum LogItemType {
 	LOG_ITEM_TYPE_FATAL,
@@ -5344,8 +6840,21 @@ int g_debuggerMode = DEBUGGER_MODE_RUN;
 void setDebuggerMessageSubsciptionFilter(uint32_t filter) {
     g_messageSubsciptionFilter = filter;
 }
+#if defined(__EMSCRIPTEN__)
+static const int OUTPUT_BUFFER_SIZE = 1024 * 1024;
+#else
+static const int OUTPUT_BUFFER_SIZE = 64;
+#endif
+static char *outputBuffer;
+int outputBufferPosition = 0;
 static bool isSubscribedTo(MessagesToDebugger messageType) {
     if (g_debuggerIsConnected && (g_messageSubsciptionFilter & (1 << messageType)) != 0) {
+        if (!outputBuffer) {
+            outputBuffer = (char *)malloc(OUTPUT_BUFFER_SIZE);
+            if (!outputBuffer) {
+                return false;
+            }
+        }
         startToDebuggerMessageHook();
         return true;
     }
@@ -5374,6 +6883,34 @@ void onDebuggerClientDisconnected() {
     g_debuggerIsConnected = false;
     setDebuggerState(DEBUGGER_STATE_RESUMED);
 }
+static void onAllocStatsRequested() {
+	if (!isSubscribedTo(MESSAGE_TO_DEBUGGER_ALLOC_STATS)) {
+		return;
+	}
+	char buffer[256];
+	uint32_t numStats = getNumAllocStats();
+	AllocStats *stats = numStats > 0 ? (AllocStats *)alloc(numStats * sizeof(AllocStats), 0x5e2b8f31) : nullptr;
+	if (!stats) {
+		numStats = 0;
+	}
+	numStats = getAllocStats(stats, numStats);
+	snprintf(buffer, sizeof(buffer), "%d\t%d", MESSAGE_TO_DEBUGGER_ALLOC_STATS, (int)numStats);
+	writeDebuggerBufferHook(buffer, strlen(buffer));
+	for (uint32_t i = 0; i < numStats; i++) {
+		snprintf(buffer, sizeof(buffer), "\t%08" PRIx32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32,
+			stats[i].id,
+			stats[i].liveBytes,
+			stats[i].liveCount,
+			stats[i].totalCount,
+			stats[i].peakBytes
+		);
+		writeDebuggerBufferHook(buffer, strlen(buffer));
+	}
+	writeDebuggerBufferHook("\n", 1);
+	if (stats) {
+		free(stats);
+	}
+}
 void processDebuggerInput(char *buffer, uint32_t length) {
 	for (uint32_t i = 0; i < length; i++) {
 		if (buffer[i] == '\n') {
@@ -5407,6 +6944,8 @@ void processDebuggerInput(char *buffer, uint32_t length) {
 				}
 			} else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_MODE) {
                 g_debuggerMode = strtol(g_inputFromDebugger + 2, nullptr, 10);
+            } else if (messageFromDebugger == MESSAGE_FROM_DEBUGGER_GET_ALLOC_STATS) {
+                onAllocStatsRequested();
             }
 			g_inputFromDebuggerPosition = 0;
 		} else {
@@ -5447,15 +6986,9 @@ bool canExecuteStep(FlowState *&flowState, unsigned &componentIndex) {
     }
     return true;
 }
-#if defined(__EMSCRIPTEN__)
-char outputBuffer[1024 * 1024];
-#else
-char outputBuffer[64];
-#endif
-int outputBufferPosition = 0;
 #define WRITE_TO_OUTPUT_BUFFER(ch) \
 	outputBuffer[outputBufferPosition++] = ch; \
-	if (outputBufferPosition == sizeof(outputBuffer)) { \
+	if (outputBufferPosition == OUTPUT_BUFFER_SIZE) { \
 		writeDebuggerBufferHook(outputBuffer, outputBufferPosition); \
 		outputBufferPosition = 0; \
 	}
@@ -5609,6 +7142,18 @@ static void writeValue(const Value &value) {
 		snprintf(tempStr, sizeof(tempStr) - 1, ">%d", (int)(value.int32Value));
 		break;
 	case VALUE_TYPE_JSON:
+        if (isJsonRef(value)) {
+            int jsonTextSize = getJsonTextLength(value) + 1;
+            char *jsonText = (char *)alloc(jsonTextSize, 0x6e1fa4c3);
+            if (jsonText) {
+                jsonToText(value, jsonText, jsonTextSize);
+                writeString(jsonText);
+                eez::free(jsonText);
+            } else {
+                writeString("");
+            }
+            return;
+        }
 		snprintf(tempStr, sizeof(tempStr) - 1, "#%d", (int)(value.int32Value));
 		break;
 	case VALUE_TYPE_DATE:
@@ -5933,9 +7478,132 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
 namespace eez {
 namespace flow {
 EvalStack g_stack;
+static const int OPERATION_TYPE_FLOW_GET_THEME_COLOR = defs_v3::OPERATION_TYPE_FLOW_THEMES + 1;
+static bool isVolatileOperation(int operation) {
+    switch (operation) {
+    case defs_v3::OPERATION_TYPE_SYSTEM_GET_TICK:
+    case defs_v3::OPERATION_TYPE_FLOW_INDEX:
+    case defs_v3::OPERATION_TYPE_FLOW_IS_PAGE_ACTIVE:
+    case defs_v3::OPERATION_TYPE_FLOW_PAGE_TIMELINE_POSITION:
+    case defs_v3::OPERATION_TYPE_FLOW_TRANSLATE:
+    case defs_v3::OPERATION_TYPE_FLOW_THEMES:
+    case defs_v3::OPERATION_TYPE_FLOW_GET_BITMAP_INDEX:
+    case defs_v3::OPERATION_TYPE_FLOW_GET_BITMAP_AS_DATA_URL:
+    case defs_v3::OPERATION_TYPE_DATE_NOW:
+    case defs_v3::OPERATION_TYPE_DATE_TO_STRING:
+    case defs_v3::OPERATION_TYPE_DATE_TO_LOCALE_STRING:
+    case defs_v3::OPERATION_TYPE_DATE_FROM_STRING:
+    case defs_v3::OPERATION_TYPE_DATE_GET_YEAR:
+    case defs_v3::OPERATION_TYPE_DATE_GET_MONTH:
+    case defs_v3::OPERATION_TYPE_DATE_GET_DAY:
+    case defs_v3::OPERATION_TYPE_DATE_GET_HOURS:
+    case defs_v3::OPERATION_TYPE_DATE_GET_MINUTES:
+    case defs_v3::OPERATION_TYPE_DATE_GET_SECONDS:
+    case defs_v3::OPERATION_TYPE_DATE_GET_MILLISECONDS:
+    case defs_v3::OPERATION_TYPE_DATE_MAKE:
+    case defs_v3::OPERATION_TYPE_LVGL_METER_TICK_INDEX:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_CODE:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_CURRENT_TARGET:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_TARGET:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_USER_DATA:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_KEY:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_GESTURE_DIR:
+    case defs_v3::OPERATION_TYPE_EVENT_GET_ROTARY_DIFF:
+    case OPERATION_TYPE_FLOW_GET_THEME_COLOR:
+        return true;
+    default:
+        return false;
+    }
+}
+static void pushLocalVariable(Value *pValue) {
+    if (g_isRecordingWatchDependencies) {
+        if (pValue->type == VALUE_TYPE_PROPERTY_REF || pValue->type == VALUE_TYPE_VALUE_PTR) {
+            recordUntrackedWatchDependency();
+        } else {
+            recordWatchDependency(pValue);
+        }
+    }
+    g_stack.push(pValue);
+}
+static void pushGlobalVariable(FlowState *flowState, FlowDefinition *flowDefinition, uint32_t globalVariableIndex) {
+    if (globalVariableIndex < flowDefinition->globalVariables.count) {
+        Value *pValue;
+        if (g_globalVariables && !flowState->assets->external) {
+            pValue = g_globalVariables->values + globalVariableIndex;
+        } else {
+            pValue = flowDefinition->globalVariables[globalVariableIndex];
+        }
+        if (g_isRecordingWatchDependencies) {
+            recordWatchDependency(pValue);
+        }
+        g_stack.push(pValue);
+    } else {
+        if (g_isRecordingWatchDependencies) {
+            recordUntrackedWatchDependency();
+        }
+        g_stack.push(Value((int)(globalVariableIndex - flowDefinition->globalVariables.count + 1), VALUE_TYPE_NATIVE_VARIABLE));
+    }
+}
+static void evalArrayElement() {
+    auto elementIndexValue = g_stack.pop().getValue();
+    auto arrayValue = g_stack.pop().getValue();
+    if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
+        g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
+    } else {
+        if (arrayValue.isArray()) {
+            auto array = arrayValue.getArray();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
+                    g_stack.push(Value::makeArrayElementRef(std::move(arrayValue), elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Array element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for array element index\n");
+            }
+        } else if (arrayValue.isBlob()) {
+            auto blobRef = arrayValue.getBlob();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
+                    g_stack.push(Value::makeArrayElementRef(std::move(arrayValue), elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Blob element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for blob element index\n");
+            }
+        } else if (isJsonRef(arrayValue)) {
+            g_stack.push(getJsonProperty(arrayValue, elementIndexValue));
+        } else {
+            g_stack.push(Value::makeError());
+            g_stack.setErrorMessage("Array value expected\n");
+        }
+    }
+}
+static void setFinalResultDstValueType(uint32_t dstValueType) {
+    if (g_stack.sp == 1) {
+        auto &finalResult = g_stack.stack[0];
+        if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
+            finalResult.dstValueType = dstValueType;
+        } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
+            auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
+            arrayElementValue->dstValueType = dstValueType;
+        }
+    }
+}
 static void evalExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
 	auto flowDefinition = static_cast<FlowDefinition*>(flowState->assets->flowDefinition);
 	auto flow = flowState->flow;
+    Value *inPlaceAssignmentTarget = g_stack.inPlaceAssignmentTarget;
+    g_stack.inPlaceAssignmentTarget = nullptr;
 	int i = 0;
 	while (true) {
 		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
@@ -5944,78 +7612,30 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
 			g_stack.push(*flowDefinition->constants[instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+            if (g_isRecordingWatchDependencies) {
+                recordUntrackedWatchDependency();
+            }
 			g_stack.push(flowState->values[instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
-			g_stack.push(&flowState->values[flow->componentInputs.count + instructionArg]);
+            pushLocalVariable(&flowState->values[flow->componentInputs.count + instructionArg]);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
-			if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
-                if (g_globalVariables && !flowState->assets->external) {
-				    g_stack.push(g_globalVariables->values + instructionArg);
-                } else {
-                    g_stack.push(flowDefinition->globalVariables[instructionArg]);
-                }
-			} else {
-				g_stack.push(Value((int)(instructionArg - flowDefinition->globalVariables.count + 1), VALUE_TYPE_NATIVE_VARIABLE));
-			}
+            pushGlobalVariable(flowState, flowDefinition, instructionArg);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
 			g_stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
-			auto elementIndexValue = g_stack.pop().getValue();
-			auto arrayValue = g_stack.pop().getValue();
-            if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
-                g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
-            } else {
-                if (arrayValue.isArray()) {
-                    auto array = arrayValue.getArray();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Array element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for array element index\n");
-                    }
-                } else if (arrayValue.isBlob()) {
-                    auto blobRef = arrayValue.getBlob();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Blob element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for blob element index\n");
-                    }
-                } else {
-                    g_stack.push(Value::makeError());
-                    g_stack.setErrorMessage("Array value expected\n");
-                }
-            }
+            evalArrayElement();
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            if (g_isRecordingWatchDependencies && isVolatileOperation(instructionArg)) {
+                recordUntrackedWatchDependency();
+            }
+            if (inPlaceAssignmentTarget && ((instructions[i + 2] + (instructions[i + 3] << 8)) & EXPR_EVAL_INSTRUCTION_TYPE_MASK) == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+                g_stack.inPlaceAssignmentTarget = inPlaceAssignmentTarget;
+            }
 			g_evalOperations[instructionArg](g_stack);
 		} else {
             if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
     			i += 2;
-                if (g_stack.sp == 1) {
-                    auto finalResult = g_stack.pop();
-                    #define VALUE_TYPE (instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) + (instructions[i + 3] << 24))
-                    if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
-                        finalResult.dstValueType = VALUE_TYPE;
-                    } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
-                        auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
-                        arrayElementValue->dstValueType = VALUE_TYPE;
-                    }
-                    g_stack.push(finalResult);
-                }
+                setFinalResultDstValueType(instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) + (instructions[i + 3] << 24));
                 i += 4;
                 break;
             } else {
@@ -6029,23 +7649,237 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		*numInstructionBytes = i;
 	}
 }
-bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
+enum CompiledInstructionType {
+    COMPILED_INSTRUCTION_PUSH_CONSTANT,
+    COMPILED_INSTRUCTION_PUSH_INPUT,
+    COMPILED_INSTRUCTION_PUSH_LOCAL_VAR,
+    COMPILED_INSTRUCTION_PUSH_GLOBAL_VAR,
+    COMPILED_INSTRUCTION_PUSH_OUTPUT,
+    COMPILED_INSTRUCTION_ARRAY_ELEMENT,
+    COMPILED_INSTRUCTION_OPERATION,
+    COMPILED_INSTRUCTION_VOLATILE_OPERATION,
+    COMPILED_INSTRUCTION_END,
+    COMPILED_INSTRUCTION_END_WITH_DST_VALUE_TYPE
+};
+struct CompiledInstruction {
+    uint16_t type;
+    uint16_t arg;
+    union {
+        const Value *pConstant;
+        uint32_t valueIndex;
+        EvalOperation operation;
+        uint32_t dstValueType;
+    };
+};
+static Assets *g_compiledAssets;
+static CompiledInstruction *g_compiledInstructions;
+static CompiledInstruction **g_compiledProperties;
+static uint32_t *g_compiledComponents;
+static uint32_t *g_compiledFlows;
+static unsigned getNumCompiledInstructions(const uint8_t *instructions) {
+    unsigned numInstructions = 0;
+	int i = 0;
+    while (true) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+        numInstructions++;
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+        if (
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT &&
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT &&
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR &&
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR &&
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT &&
+            instructionType != EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT &&
+            instructionType != EXPR_EVAL_INSTRUCTION_TYPE_OPERATION
+        ) {
+            return numInstructions;
+        }
+        i += 2;
+    }
+}
+static CompiledInstruction *compileExpression(Flow *flow, FlowDefinition *flowDefinition, const uint8_t *instructions, CompiledInstruction *compiledInstruction) {
+	int i = 0;
+    while (true) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+        compiledInstruction->arg = instructionArg;
+		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_PUSH_CONSTANT;
+            compiledInstruction->pConstant = flowDefinition->constants[instructionArg];
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_PUSH_INPUT;
+            compiledInstruction->valueIndex = instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_PUSH_LOCAL_VAR;
+            compiledInstruction->valueIndex = flow->componentInputs.count + instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_PUSH_GLOBAL_VAR;
+            compiledInstruction->valueIndex = instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_PUSH_OUTPUT;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_ARRAY_ELEMENT;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            compiledInstruction->type = isVolatileOperation(instructionArg) ? COMPILED_INSTRUCTION_VOLATILE_OPERATION : COMPILED_INSTRUCTION_OPERATION;
+            compiledInstruction->operation = g_evalOperations[instructionArg];
+        } else if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
+            compiledInstruction->type = COMPILED_INSTRUCTION_END_WITH_DST_VALUE_TYPE;
+            compiledInstruction->dstValueType = instructions[i + 2] + (instructions[i + 3] << 8) + (instructions[i + 4] << 16) + (instructions[i + 5] << 24);
+            return compiledInstruction + 1;
+        } else {
+            compiledInstruction->type = COMPILED_INSTRUCTION_END;
+            return compiledInstruction + 1;
+        }
+        compiledInstruction++;
+        i += 2;
+    }
+}
+void freeCompiledExpressions() {
+    if (g_compiledInstructions) {
+        free(g_compiledInstructions);
+        free(g_compiledProperties);
+        free(g_compiledComponents);
+        free(g_compiledFlows);
+    }
+    g_compiledAssets = nullptr;
+    g_compiledInstructions = nullptr;
+    g_compiledProperties = nullptr;
+    g_compiledComponents = nullptr;
+    g_compiledFlows = nullptr;
+}
+void compileExpressions(Assets *assets) {
+    freeCompiledExpressions();
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    unsigned numComponents = 0;
+    unsigned numProperties = 0;
+    unsigned numInstructions = 0;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        numComponents += flow->components.count;
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            auto component = flow->components[componentIndex];
+            numProperties += component->properties.count;
+            for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+                numInstructions += getNumCompiledInstructions(component->properties[propertyIndex]->evalInstructions);
+            }
+        }
+    }
+    g_compiledFlows = (uint32_t *)alloc((flowDefinition->flows.count + 1) * sizeof(uint32_t), 0x0f4be2d1);
+    g_compiledComponents = (uint32_t *)alloc((numComponents + 1) * sizeof(uint32_t), 0x3d6ac5a0);
+    g_compiledProperties = (CompiledInstruction **)alloc((numProperties + 1) * sizeof(CompiledInstruction *), 0x8e1f7b62);
+    g_compiledInstructions = (CompiledInstruction *)alloc((numInstructions + 1) * sizeof(CompiledInstruction), 0x71c9340e);
+    if (!g_compiledFlows || !g_compiledComponents || !g_compiledProperties || !g_compiledInstructions) {
+        if (g_compiledFlows) free(g_compiledFlows);
+        if (g_compiledComponents) free(g_compiledComponents);
+        if (g_compiledProperties) free(g_compiledProperties);
+        if (g_compiledInstructions) free(g_compiledInstructions);
+        g_compiledFlows = nullptr;
+        g_compiledComponents = nullptr;
+        g_compiledProperties = nullptr;
+        g_compiledInstructions = nullptr;
+        return;
+    }
+    unsigned componentOffset = 0;
+    unsigned propertyOffset = 0;
+    auto compiledInstruction = g_compiledInstructions;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        g_compiledFlows[flowIndex] = componentOffset;
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            auto component = flow->components[componentIndex];
+            g_compiledComponents[componentOffset++] = propertyOffset;
+            for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+                g_compiledProperties[propertyOffset++] = compiledInstruction;
+                compiledInstruction = compileExpression(flow, flowDefinition, component->properties[propertyIndex]->evalInstructions, compiledInstruction);
+            }
+        }
+    }
+    g_compiledAssets = assets;
+}
+static inline const CompiledInstruction *getCompiledProperty(FlowState *flowState, int componentIndex, int propertyIndex) {
+    if (flowState->assets != g_compiledAssets) {
+        return nullptr;
+    }
+    return g_compiledProperties[g_compiledComponents[g_compiledFlows[flowState->flowIndex] + componentIndex] + propertyIndex];
+}
+static void evalCompiledExpression(FlowState *flowState, const CompiledInstruction *compiledInstruction) {
+    auto values = flowState->values;
+    Value *inPlaceAssignmentTarget = g_stack.inPlaceAssignmentTarget;
+    g_stack.inPlaceAssignmentTarget = nullptr;
+    while (true) {
+        switch (compiledInstruction->type) {
+        case COMPILED_INSTRUCTION_PUSH_CONSTANT:
+            g_stack.push(*compiledInstruction->pConstant);
+            break;
+        case COMPILED_INSTRUCTION_PUSH_INPUT:
+            if (g_isRecordingWatchDependencies) {
+                recordUntrackedWatchDependency();
+            }
+            g_stack.push(values[compiledInstruction->valueIndex]);
+            break;
+        case COMPILED_INSTRUCTION_PUSH_LOCAL_VAR:
+            pushLocalVariable(&values[compiledInstruction->valueIndex]);
+            break;
+        case COMPILED_INSTRUCTION_PUSH_GLOBAL_VAR:
+            pushGlobalVariable(flowState, static_cast<FlowDefinition*>(flowState->assets->flowDefinition), compiledInstruction->valueIndex);
+            break;
+        case COMPILED_INSTRUCTION_PUSH_OUTPUT:
+            g_stack.push(Value(compiledInstruction->arg, VALUE_TYPE_FLOW_OUTPUT));
+            break;
+        case COMPILED_INSTRUCTION_ARRAY_ELEMENT:
+            evalArrayElement();
+            break;
+        case COMPILED_INSTRUCTION_VOLATILE_OPERATION:
+            if (g_isRecordingWatchDependencies) {
+                recordUntrackedWatchDependency();
+            }
+            compiledInstruction->operation(g_stack);
+            break;
+        case COMPILED_INSTRUCTION_OPERATION:
+            if (inPlaceAssignmentTarget && compiledInstruction[1].type >= COMPILED_INSTRUCTION_END) {
+                g_stack.inPlaceAssignmentTarget = inPlaceAssignmentTarget;
+            }
+            compiledInstruction->operation(g_stack);
+            break;
+        case COMPILED_INSTRUCTION_END_WITH_DST_VALUE_TYPE:
+            setFinalResultDstValueType(compiledInstruction->dstValueType);
+            return;
+        default:
+            return;
+        }
+        compiledInstruction++;
+    }
+}
+static bool doEvalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, const CompiledInstruction *compiledInstructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators, Value *inPlaceAssignmentTarget) {
     size_t savedSp = g_stack.sp;
     FlowState *savedFlowState = g_stack.flowState;
 	int savedComponentIndex = g_stack.componentIndex;
 	const int32_t *savedIterators = g_stack.iterators;
     const char *savedErrorMessage = g_stack.errorMessage;
+    Value *savedInPlaceAssignmentTarget = g_stack.inPlaceAssignmentTarget;
 	g_stack.flowState = flowState;
 	g_stack.componentIndex = componentIndex;
 	g_stack.iterators = iterators;
     g_stack.errorMessage = nullptr;
-	evalExpression(flowState, instructions, numInstructionBytes);
+    g_stack.inPlaceAssignmentTarget = inPlaceAssignmentTarget;
+    if (compiledInstructions) {
+        evalCompiledExpression(flowState, compiledInstructions);
+    } else {
+	    evalExpression(flowState, instructions, numInstructionBytes);
+    }
 	g_stack.flowState = savedFlowState;
 	g_stack.componentIndex = savedComponentIndex;
 	g_stack.iterators = savedIterators;
     g_stack.errorMessage = savedErrorMessage;
+    g_stack.inPlaceAssignmentTarget = savedInPlaceAssignmentTarget;
     if (g_stack.sp == savedSp + 1) {
-            result = g_stack.pop().getValue();
+            auto value = g_stack.pop();
+            if (value.isIndirectValueType()) {
+                result = value.getValue();
+            } else {
+                result = std::move(value);
+            }
             if (!result.isError()) {
                 return true;
             }
@@ -6054,20 +7888,27 @@ bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *ins
     throwError(flowState, componentIndex, flowError);
 	return false;
 }
-bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
+static bool doEvalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, const CompiledInstruction *compiledInstructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
     FlowState *savedFlowState = g_stack.flowState;
 	int savedComponentIndex = g_stack.componentIndex;
 	const int32_t *savedIterators = g_stack.iterators;
     const char *savedErrorMessage = g_stack.errorMessage;
+    Value *savedInPlaceAssignmentTarget = g_stack.inPlaceAssignmentTarget;
 	g_stack.flowState = flowState;
 	g_stack.componentIndex = componentIndex;
 	g_stack.iterators = iterators;
     g_stack.errorMessage = nullptr;
-	evalExpression(flowState, instructions, numInstructionBytes);
+    g_stack.inPlaceAssignmentTarget = nullptr;
+    if (compiledInstructions) {
+        evalCompiledExpression(flowState, compiledInstructions);
+    } else {
+	    evalExpression(flowState, instructions, numInstructionBytes);
+    }
 	g_stack.flowState = savedFlowState;
 	g_stack.componentIndex = savedComponentIndex;
 	g_stack.iterators = savedIterators;
     g_stack.errorMessage = savedErrorMessage;
+    g_stack.inPlaceAssignmentTarget = savedInPlaceAssignmentTarget;
     if (g_stack.sp == 1) {
         auto finalResult = g_stack.pop();
         if (
@@ -6077,7 +7918,7 @@ bool evalAssignableExpression(FlowState *flowState, int componentIndex, const ui
             finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE ||
             finalResult.getType() == VALUE_TYPE_JSON_MEMBER_VALUE
         ) {
-            result = finalResult;
+            result = std::move(finalResult);
             return true;
         }
     }
@@ -6085,6 +7926,12 @@ bool evalAssignableExpression(FlowState *flowState, int componentIndex, const ui
     throwError(flowState, componentIndex, errorMessage);
 	return false;
 }
+bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators, Value *inPlaceAssignmentTarget) {
+    return doEvalExpression(flowState, componentIndex, instructions, nullptr, result, errorMessage, numInstructionBytes, iterators, inPlaceAssignmentTarget);
+}
+bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
+    return doEvalAssignableExpression(flowState, componentIndex, instructions, nullptr, result, errorMessage, numInstructionBytes, iterators);
+}
 bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
     if (componentIndex < 0 || componentIndex >= (int)flowState->flow->components.count) {
         char message[256];
@@ -6101,7 +7948,7 @@ bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, V
         throwError(flowState, componentIndex, flowError);
         return false;
     }
-    return evalExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, result, errorMessage, numInstructionBytes, iterators);
+    return doEvalExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, numInstructionBytes ? nullptr : getCompiledProperty(flowState, componentIndex, propertyIndex), result, errorMessage, numInstructionBytes, iterators, nullptr);
 }
 bool evalAssignableProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
     if (componentIndex < 0 || componentIndex >= (int)flowState->flow->components.count) {
@@ -6119,7 +7966,7 @@ bool evalAssignableProperty(FlowState *flowState, int componentIndex, int proper
         throwError(flowState, componentIndex, flowError);
         return false;
     }
-    return evalAssignableExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, result, errorMessage, numInstructionBytes, iterators);
+    return doEvalAssignableExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, numInstructionBytes ? nullptr : getCompiledProperty(flowState, componentIndex, propertyIndex), result, errorMessage, numInstructionBytes, iterators);
 }
 } 
 } 
@@ -6154,6 +8001,8 @@ unsigned start(Assets *assets) {
     if (!assets->external) {
 	    queueReset();
         watchListReset();
+        timersReset();
+        compileExpressions(assets);
     }
     scpiComponentInitHook();
 	onStarted(assets);
@@ -6168,6 +8017,7 @@ void tick() {
         return;
     }
 	uint32_t startTickCount = millis();
+    processTimers();
     visitWatchList();
     auto queueSizeAtTickStart = getQueueSize();
     for (size_t i = 0; i < queueSizeAtTickStart || g_numNonContinuousTaskInQueue > 0; i++) {
@@ -6246,10 +8096,23 @@ void doStop() {
     g_isStopped = true;
 	queueReset();
     watchListReset();
+    timersReset();
+    freeCompiledExpressions();
+    trimAllocHeap();
 }
 bool isFlowStopped() {
     return g_isStopped;
 }
+bool getNextTickDeadline(uint32_t &deadline) {
+    if (isFlowStopped()) {
+        return false;
+    }
+    if (g_isStopping || getQueueSize() > 0 || getWatchListSize() > 0) {
+        deadline = millis();
+        return true;
+    }
+    return getNextTimerDeadline(deadline);
+}
 unsigned getTickMaxDurationCounter() {
     return g_tick_max_duration_count;
 }
@@ -6307,8 +8170,10 @@ void setGlobalVariable(Assets *assets, uint32_t globalVariableIndex, const Value
     if (globalVariableIndex < assets->flowDefinition->globalVariables.count) {
         if (g_globalVariables && !assets->external) {
             g_globalVariables->values[globalVariableIndex] = value;
+            onWatchedValueChanged(g_globalVariables->values + globalVariableIndex);
         } else {
             *assets->flowDefinition->globalVariables[globalVariableIndex] = value;
+            onWatchedValueChanged(assets->flowDefinition->globalVariables[globalVariableIndex]);
         }
     }
 }
@@ -6746,6 +8611,9 @@ extern "C" void eez_flow_tick() {
 extern "C" bool eez_flow_is_stopped() {
     return eez::flow::isFlowStopped();
 }
+extern "C" bool eez_flow_get_next_tick_deadline(uint32_t *deadline) {
+    return eez::flow::getNextTickDeadline(*deadline);
+}
 namespace eez {
 ActionExecFunc g_actionExecFunctions[] = { 0 };
 }
@@ -6990,28 +8858,175 @@ extern "C" {
 int g_eezFlowLvlgMeterTickIndex = 0;
 namespace eez {
 namespace flow {
-Value op_add(const Value& a1, const Value& b1) {
-    if (a1.isError()) {
-        return a1;
+enum OperandKind {
+    OPERAND_KIND_OTHER,
+    OPERAND_KIND_INT32,
+    OPERAND_KIND_FLOAT,
+    OPERAND_KIND_DOUBLE,
+    OPERAND_KIND_STRING,
+    OPERAND_KIND_COUNT
+};
+typedef Value (*BinaryOperationKernel)(const Value &a, const Value &b);
+typedef BinaryOperationKernel BinaryOperationKernels[OPERAND_KIND_COUNT][OPERAND_KIND_COUNT];
+static inline const Value &resolveOperand(const Value &value) {
+    const Value *pValue = &value;
+    while (pValue->type == VALUE_TYPE_VALUE_PTR) {
+        pValue = pValue->pValueValue;
+    }
+    return *pValue;
+}
+static inline int getOperandKind(const Value &value) {
+    switch (value.type) {
+    case VALUE_TYPE_INT32:
+        return OPERAND_KIND_INT32;
+    case VALUE_TYPE_FLOAT:
+        return OPERAND_KIND_FLOAT;
+    case VALUE_TYPE_DOUBLE:
+        return OPERAND_KIND_DOUBLE;
+    case VALUE_TYPE_STRING:
+    case VALUE_TYPE_STRING_ASSET:
+    case VALUE_TYPE_STRING_REF:
+        return OPERAND_KIND_STRING;
+    default:
+        return OPERAND_KIND_OTHER;
     }
-    if (b1.isError()) {
-        return b1;
+}
+static inline bool dispatchBinaryOperation(const BinaryOperationKernels &kernels, const Value &a1, const Value &b1, Value &result) {
+    const Value &a = resolveOperand(a1);
+    const Value &b = resolveOperand(b1);
+    auto kernel = kernels[getOperandKind(a)][getOperandKind(b)];
+    if (!kernel) {
+        return false;
     }
-    auto a = a1.getValue();
-    auto b = b1.getValue();
-    if (a.isBlob() || b.isBlob()) {
-        if (a.isBlob()) {
-            if (b.isUndefinedOrNull()) {
-                return a;
-            }
-            if (!b.isBlob()) {
-                return Value::makeError();
-            }
-        } else {
-            if (a.isUndefinedOrNull()) {
-                return b;
-            }
-            return Value::makeError();
+    result = kernel(a, b);
+    return true;
+}
+static bool isStringEqual(const Value &a, const Value &b) {
+    const char *aStr = a.getString();
+    const char *bStr = b.getString();
+    if (!aStr && !bStr) {
+        return true;
+    }
+    if (!aStr || !bStr) {
+        return false;
+    }
+    return strcmp(aStr, bStr) == 0;
+}
+static bool isStringLess(const Value &a, const Value &b) {
+    const char *aStr = a.getString();
+    const char *bStr = b.getString();
+    if (!aStr || !bStr) {
+        return false;
+    }
+    return strcmp(aStr, bStr) < 0;
+}
+static inline bool isFloatEqual(const Value &a, const Value &b) {
+    return a.floatValue == b.floatValue && a.unit == b.unit && a.options == b.options;
+}
+static inline bool isDoubleEqual(const Value &a, const Value &b) {
+    return a.doubleValue == b.doubleValue && a.unit == b.unit && a.options == b.options;
+}
+static Value add_INT32_INT32(const Value &a, const Value &b) { return Value((int)(a.int32Value + b.int32Value), VALUE_TYPE_INT32); }
+static Value add_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue + b.floatValue, VALUE_TYPE_FLOAT); }
+static Value add_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue + b.doubleValue, VALUE_TYPE_DOUBLE); }
+static Value add_STRING_STRING(const Value &a, const Value &b) { return Value::concatenateString(a, b); }
+static Value sub_INT32_INT32(const Value &a, const Value &b) { return Value((int)(a.int32Value - b.int32Value), VALUE_TYPE_INT32); }
+static Value sub_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue - b.floatValue, VALUE_TYPE_FLOAT); }
+static Value sub_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue - b.doubleValue, VALUE_TYPE_DOUBLE); }
+static Value mul_INT32_INT32(const Value &a, const Value &b) { return Value((int)(a.int32Value * b.int32Value), VALUE_TYPE_INT32); }
+static Value mul_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue * b.floatValue, VALUE_TYPE_FLOAT); }
+static Value mul_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue * b.doubleValue, VALUE_TYPE_DOUBLE); }
+static Value div_INT32_INT32(const Value &a, const Value &b) {
+    if (b.int32Value == 0) {
+        return Value::makeError();
+    }
+    return Value(1.0 * a.int32Value / b.int32Value, VALUE_TYPE_DOUBLE);
+}
+static Value div_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue / b.floatValue, VALUE_TYPE_FLOAT); }
+static Value div_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue / b.doubleValue, VALUE_TYPE_DOUBLE); }
+static Value mod_INT32_INT32(const Value &a, const Value &b) {
+    if (b.int32Value == 0) {
+        return Value::makeError();
+    }
+    return Value((int)(a.int32Value % b.int32Value), VALUE_TYPE_INT32);
+}
+static Value mod_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue - floor(a.floatValue / b.floatValue) * b.floatValue, VALUE_TYPE_FLOAT); }
+static Value mod_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue - floor(a.doubleValue / b.doubleValue) * b.doubleValue, VALUE_TYPE_DOUBLE); }
+static Value eq_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value == b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value eq_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(isFloatEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value eq_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(isDoubleEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value eq_STRING_STRING(const Value &a, const Value &b) { return Value(isStringEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value neq_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value != b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value neq_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(!isFloatEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value neq_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(!isDoubleEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value neq_STRING_STRING(const Value &a, const Value &b) { return Value(!isStringEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value less_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value < b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value less_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue < b.floatValue, VALUE_TYPE_BOOLEAN); }
+static Value less_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue < b.doubleValue, VALUE_TYPE_BOOLEAN); }
+static Value less_STRING_STRING(const Value &a, const Value &b) { return Value(isStringLess(a, b), VALUE_TYPE_BOOLEAN); }
+static Value great_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value > b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value great_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(!(a.floatValue < b.floatValue) && !isFloatEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value great_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(!(a.doubleValue < b.doubleValue) && !isDoubleEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value great_STRING_STRING(const Value &a, const Value &b) { return Value(!isStringLess(a, b) && !isStringEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value less_eq_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value <= b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value less_eq_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(a.floatValue < b.floatValue || isFloatEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value less_eq_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(a.doubleValue < b.doubleValue || isDoubleEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value less_eq_STRING_STRING(const Value &a, const Value &b) { return Value(isStringLess(a, b) || isStringEqual(a, b), VALUE_TYPE_BOOLEAN); }
+static Value great_eq_INT32_INT32(const Value &a, const Value &b) { return Value(a.int32Value >= b.int32Value, VALUE_TYPE_BOOLEAN); }
+static Value great_eq_FLOAT_FLOAT(const Value &a, const Value &b) { return Value(!(a.floatValue < b.floatValue), VALUE_TYPE_BOOLEAN); }
+static Value great_eq_DOUBLE_DOUBLE(const Value &a, const Value &b) { return Value(!(a.doubleValue < b.doubleValue), VALUE_TYPE_BOOLEAN); }
+static Value great_eq_STRING_STRING(const Value &a, const Value &b) { return Value(!isStringLess(a, b), VALUE_TYPE_BOOLEAN); }
+#define NUMERIC_KERNELS(NAME) { \
+    { nullptr, nullptr, nullptr, nullptr, nullptr }, \
+    { nullptr, NAME##_INT32_INT32, nullptr, nullptr, nullptr }, \
+    { nullptr, nullptr, NAME##_FLOAT_FLOAT, nullptr, nullptr }, \
+    { nullptr, nullptr, nullptr, NAME##_DOUBLE_DOUBLE, nullptr }, \
+    { nullptr, nullptr, nullptr, nullptr, nullptr } \
+}
+#define NUMERIC_AND_STRING_KERNELS(NAME) { \
+    { nullptr, nullptr, nullptr, nullptr, nullptr }, \
+    { nullptr, NAME##_INT32_INT32, nullptr, nullptr, nullptr }, \
+    { nullptr, nullptr, NAME##_FLOAT_FLOAT, nullptr, nullptr }, \
+    { nullptr, nullptr, nullptr, NAME##_DOUBLE_DOUBLE, nullptr }, \
+    { nullptr, nullptr, nullptr, nullptr, NAME##_STRING_STRING } \
+}
+static const BinaryOperationKernels g_addKernels = NUMERIC_AND_STRING_KERNELS(add);
+static const BinaryOperationKernels g_subKernels = NUMERIC_KERNELS(sub);
+static const BinaryOperationKernels g_mulKernels = NUMERIC_KERNELS(mul);
+static const BinaryOperationKernels g_divKernels = NUMERIC_KERNELS(div);
+static const BinaryOperationKernels g_modKernels = NUMERIC_KERNELS(mod);
+static const BinaryOperationKernels g_eqKernels = NUMERIC_AND_STRING_KERNELS(eq);
+static const BinaryOperationKernels g_neqKernels = NUMERIC_AND_STRING_KERNELS(neq);
+static const BinaryOperationKernels g_lessKernels = NUMERIC_AND_STRING_KERNELS(less);
+static const BinaryOperationKernels g_greatKernels = NUMERIC_AND_STRING_KERNELS(great);
+static const BinaryOperationKernels g_lessEqKernels = NUMERIC_AND_STRING_KERNELS(less_eq);
+static const BinaryOperationKernels g_greatEqKernels = NUMERIC_AND_STRING_KERNELS(great_eq);
+Value op_add(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_addKernels, a1, b1, result)) {
+        return result;
+    }
+    if (a1.isError()) {
+        return a1;
+    }
+    if (b1.isError()) {
+        return b1;
+    }
+    auto a = a1.getValue();
+    auto b = b1.getValue();
+    if (a.isBlob() || b.isBlob()) {
+        if (a.isBlob()) {
+            if (b.isUndefinedOrNull()) {
+                return a;
+            }
+            if (!b.isBlob()) {
+                return Value::makeError();
+            }
+        } else {
+            if (a.isUndefinedOrNull()) {
+                return b;
+            }
+            return Value::makeError();
         }
         auto aBlob = a.getBlob();
         auto bBlob = b.getBlob();
@@ -7025,10 +9040,7 @@ Value op_add(const Value& a1, const Value& b1) {
     if (a.isString() || b.isString()) {
         Value value1 = a.toString(0x84eafaa8);
         Value value2 = b.toString(0xd273cab6);
-        auto res = Value::concatenateString(value1, value2);
-        char str1[128];
-        res.toText(str1, sizeof(str1));
-        return res;
+        return Value::concatenateString(value1, value2);
     }
     if (a.isDouble() || b.isDouble()) {
         return Value(a.toDouble() + b.toDouble(), VALUE_TYPE_DOUBLE);
@@ -7042,6 +9054,10 @@ Value op_add(const Value& a1, const Value& b1) {
     return Value((int)(a.int32Value + b.int32Value), VALUE_TYPE_INT32);
 }
 Value op_sub(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_subKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7068,6 +9084,10 @@ Value op_sub(const Value& a1, const Value& b1) {
     return Value((int)(a.int32Value - b.int32Value), VALUE_TYPE_INT32);
 }
 Value op_mul(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_mulKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7094,6 +9114,10 @@ Value op_mul(const Value& a1, const Value& b1) {
     return Value((int)(a.int32Value * b.int32Value), VALUE_TYPE_INT32);
 }
 Value op_div(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_divKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7127,6 +9151,10 @@ Value op_div(const Value& a1, const Value& b1) {
     return Value(1.0 * a.int32Value / b.int32Value, VALUE_TYPE_DOUBLE);
 }
 Value op_mod(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_modKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7319,6 +9347,10 @@ static bool is_great(const Value& a1, const Value& b1) {
     return !is_less(a1, b1) && !is_equal(a1, b1);
 }
 Value op_eq(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_eqKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7328,6 +9360,10 @@ Value op_eq(const Value& a1, const Value& b1) {
     return Value(is_equal(a1, b1), VALUE_TYPE_BOOLEAN);
 }
 Value op_neq(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_neqKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7337,6 +9373,10 @@ Value op_neq(const Value& a1, const Value& b1) {
     return Value(!is_equal(a1, b1), VALUE_TYPE_BOOLEAN);
 }
 Value op_less(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_lessKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7346,6 +9386,10 @@ Value op_less(const Value& a1, const Value& b1) {
     return Value(is_less(a1, b1), VALUE_TYPE_BOOLEAN);
 }
 Value op_great(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_greatKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7355,6 +9399,10 @@ Value op_great(const Value& a1, const Value& b1) {
     return Value(is_great(a1, b1), VALUE_TYPE_BOOLEAN);
 }
 Value op_less_eq(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_lessEqKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7364,6 +9412,10 @@ Value op_less_eq(const Value& a1, const Value& b1) {
     return Value(is_less(a1, b1) || is_equal(a1, b1), VALUE_TYPE_BOOLEAN);
 }
 Value op_great_eq(const Value& a1, const Value& b1) {
+    Value result;
+    if (dispatchBinaryOperation(g_greatEqKernels, a1, b1, result)) {
+        return result;
+    }
     if (a1.isError()) {
         return a1;
     }
@@ -7379,7 +9431,7 @@ static void do_OPERATION_TYPE_ADD(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_SUB(EvalStack &stack) {
     auto b = stack.pop();
@@ -7388,7 +9440,7 @@ static void do_OPERATION_TYPE_SUB(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_MUL(EvalStack &stack) {
     auto b = stack.pop();
@@ -7397,7 +9449,7 @@ static void do_OPERATION_TYPE_MUL(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_DIV(EvalStack &stack) {
     auto b = stack.pop();
@@ -7406,7 +9458,7 @@ static void do_OPERATION_TYPE_DIV(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_MOD(EvalStack &stack) {
     auto b = stack.pop();
@@ -7415,7 +9467,7 @@ static void do_OPERATION_TYPE_MOD(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_LEFT_SHIFT(EvalStack &stack) {
     auto b = stack.pop();
@@ -7424,7 +9476,7 @@ static void do_OPERATION_TYPE_LEFT_SHIFT(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_RIGHT_SHIFT(EvalStack &stack) {
     auto b = stack.pop();
@@ -7433,7 +9485,7 @@ static void do_OPERATION_TYPE_RIGHT_SHIFT(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_BINARY_AND(EvalStack &stack) {
     auto b = stack.pop();
@@ -7442,7 +9494,7 @@ static void do_OPERATION_TYPE_BINARY_AND(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_BINARY_OR(EvalStack &stack) {
     auto b = stack.pop();
@@ -7451,7 +9503,7 @@ static void do_OPERATION_TYPE_BINARY_OR(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_BINARY_XOR(EvalStack &stack) {
     auto b = stack.pop();
@@ -7460,7 +9512,7 @@ static void do_OPERATION_TYPE_BINARY_XOR(EvalStack &stack) {
     if (result.getType() == VALUE_TYPE_UNDEFINED) {
         result = Value::makeError();
     }
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_EQUAL(EvalStack &stack) {
     auto b = stack.pop();
@@ -7697,7 +9749,7 @@ static void do_OPERATION_TYPE_FLOW_MAKE_ARRAY_VALUE(EvalStack &stack) {
             array->values[i] = Value();
         }
     }
-    stack.push(arrayValue);
+    stack.push(std::move(arrayValue));
 }
 static void do_OPERATION_TYPE_FLOW_LANGUAGES(EvalStack &stack) {
     auto &languages = stack.flowState->assets->languages;
@@ -7706,7 +9758,7 @@ static void do_OPERATION_TYPE_FLOW_LANGUAGES(EvalStack &stack) {
     for (uint32_t i = 0; i < languages.count; i++) {
         array->values[i] = Value((const char *)(languages[i]->languageID));
     }
-    stack.push(arrayValue);
+    stack.push(std::move(arrayValue));
 }
 static void do_OPERATION_TYPE_FLOW_TRANSLATE(EvalStack &stack) {
     auto textResourceIndexValue = stack.pop();
@@ -7734,7 +9786,7 @@ static void do_OPERATION_TYPE_FLOW_THEMES(EvalStack &stack) {
     for (uint32_t i = 0; i < themes.count; i++) {
         array->values[i] = Value((const char *)(themes[i]->name));
     }
-    stack.push(arrayValue);
+    stack.push(std::move(arrayValue));
 }
 static void do_OPERATION_TYPE_FLOW_GET_THEME_COLOR(EvalStack &stack) {
     auto colorIndexValue = stack.pop();
@@ -8291,7 +10343,7 @@ static void do_OPERATION_TYPE_MATH_MIN(EvalStack &stack) {
             minValue = value;
         }
     }
-    stack.push(minValue);
+    stack.push(std::move(minValue));
 }
 static void do_OPERATION_TYPE_MATH_MAX(EvalStack &stack) {
     auto numArgs = stack.pop().getInt();
@@ -8306,7 +10358,7 @@ static void do_OPERATION_TYPE_MATH_MAX(EvalStack &stack) {
             maxValue = value;
         }
     }
-    stack.push(maxValue);
+    stack.push(std::move(maxValue));
 }
 static void do_OPERATION_TYPE_STRING_LENGTH(EvalStack &stack) {
     auto a = stack.pop().getValue();
@@ -8347,7 +10399,7 @@ static void do_OPERATION_TYPE_STRING_SUBSTRING(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
-    int strLen = (int)strlen(str);
+    int strLen = (int)strValue.getStringLength();
     int err = 0;
     int start = startValue.toInt32(&err);
     if (err != 0) {
@@ -8375,6 +10427,10 @@ static void do_OPERATION_TYPE_STRING_SUBSTRING(EvalStack &stack) {
         end = strLen;
     }
     if (start < end) {
+        if (end == strLen) {
+            stack.push(Value::makeStringSuffixRef(strValue, start, 0x203b08a2));
+            return;
+        }
         Value resultValue = Value::makeStringRef(str + start, end - start, 0x203b08a2);
         stack.push(resultValue);
         return;
@@ -8456,35 +10512,113 @@ static size_t do_string_format(FormatType type, const Value& b, char *result, si
     }
     return snprintf(result, result_size, format, b.getString());
 }
-static void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
-    auto a = stack.pop().getValue();
-    if (a.isError()) {
-        stack.push(a);
-        return;
+static const size_t STRING_FORMAT_PROGRAM_MAX_FORMAT_LENGTH = 23;
+static const size_t STRING_FORMAT_PROGRAM_MAX_PREFIX_LENGTH = 32;
+static const int STRING_FORMAT_PROGRAM_MAX_WIDTH = 32;
+static const int STRING_FORMAT_PROGRAM_MAX_PRECISION = 9;
+static const uint32_t STRING_FORMAT_PROGRAM_CACHE_SIZE = 16;
+struct StringFormatProgram {
+    const char *format;
+    char formatCopy[STRING_FORMAT_PROGRAM_MAX_FORMAT_LENGTH + 1];
+    FormatType type;
+    bool fast;
+    char specifier;
+    char sign;
+    bool leftAlign;
+    bool zeroPad;
+    uint8_t width;
+    int8_t precision;
+    uint8_t prefixLength;
+};
+static StringFormatProgram g_stringFormatPrograms[STRING_FORMAT_PROGRAM_CACHE_SIZE];
+static const double g_powersOf10[STRING_FORMAT_PROGRAM_MAX_PRECISION + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+static void compileFastStringFormat(const char *format, StringFormatProgram &program) {
+    program.fast = false;
+    const char *p = format;
+    while (*p && *p != '%') {
+        p++;
+    }
+    if (*p != '%' || (size_t)(p - format) > STRING_FORMAT_PROGRAM_MAX_PREFIX_LENGTH) {
+        return;
+    }
+    program.prefixLength = (uint8_t)(p - format);
+    p++;
+    program.sign = 0;
+    program.leftAlign = false;
+    program.zeroPad = false;
+    for (;; p++) {
+        if (*p == '-') {
+            program.leftAlign = true;
+        } else if (*p == '0') {
+            program.zeroPad = true;
+        } else if (*p == '+') {
+            program.sign = '+';
+        } else if (*p == ' ') {
+            if (program.sign != '+') {
+                program.sign = ' ';
+            }
+        } else {
+            break;
+        }
     }
-    auto b = stack.pop().getValue();
-    if (b.isError()) {
-        stack.push(b);
-        return;
+    if (program.leftAlign) {
+        program.zeroPad = false;
     }
-    if (!a.isString()) {
-        stack.push(Value::makeError());
+    int width = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        width = width * 10 + (*p - '0');
+        if (width > STRING_FORMAT_PROGRAM_MAX_WIDTH) {
+            return;
+        }
+    }
+    int precision = -1;
+    if (*p == '.') {
+        p++;
+        precision = 0;
+        for (; *p >= '0' && *p <= '9'; p++) {
+            precision = precision * 10 + (*p - '0');
+            if (precision > STRING_FORMAT_PROGRAM_MAX_PRECISION) {
+                return;
+            }
+        }
+    }
+    char specifier = *p++;
+    if (*p) {
         return;
     }
-    const char *format = a.getString();
-    size_t formatLength = strlen(format);
-    if (formatLength == 0) {
-        stack.push(Value::makeError());
+    if (specifier == 'd' || specifier == 'i') {
+        if (program.type != type_int || precision != -1) {
+            return;
+        }
+    } else if (specifier == 'u') {
+        if (program.type != type_unsigned_int || precision != -1) {
+            return;
+        }
+        program.sign = 0;
+    } else if (specifier == 'f' || specifier == 'F') {
+        if (program.type != type_double) {
+            return;
+        }
+        if (precision == -1) {
+            precision = 6;
+        }
+    } else {
         return;
     }
+    program.specifier = specifier;
+    program.width = (uint8_t)width;
+    program.precision = (int8_t)precision;
+    program.fast = true;
+}
+static bool compileStringFormat(const char *format, size_t formatLength, StringFormatProgram &program) {
     char specifier = format[formatLength-1];
     char l1 = formatLength > 1 ? format[formatLength-2] : 0;
     char l2 = formatLength > 2 ? format[formatLength-3] : 0;
     FormatLength length = length_none;
     if (l1 == 'h' && l2 == 'h') length = length_hh;
     else if (l1 == 'h') length = length_h;
-    else if (l1 == 'l') length = length_l;
     else if (l1 == 'l' && l2 == 'l') length = length_ll;
+    else if (l1 == 'l') length = length_l;
     else if (l1 == 'j') length = length_j;
     else if (l1 == 'z') length = length_z;
     else if (l1 == 't') length = length_t;
@@ -8506,8 +10640,7 @@ static void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
         } else if (length == length_z) {
             type = type_size_t;
         } else {
-            stack.push(Value::makeError());
-            return;
+            return false;
         }
     } else if (specifier == 'u' || specifier == 'o' || specifier == 'x' || specifier == 'X') {
         if (length == length_none) {
@@ -8525,8 +10658,7 @@ static void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
         } else if (length == length_z) {
             type = type_size_t;
         } else {
-            stack.push(Value::makeError());
-            return;
+            return false;
         }
     } else if (specifier == 'f' || specifier == 'F' || specifier == 'e' || specifier == 'E' || specifier == 'g' || specifier == 'G' || specifier == 'a' || specifier == 'A') {
         type = type_double;
@@ -8535,12 +10667,148 @@ static void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
     } else if (specifier == 's') {
         type = type_string;
     } else {
+        return false;
+    }
+    program.type = type;
+    compileFastStringFormat(format, program);
+    return true;
+}
+static const StringFormatProgram *getStringFormatProgram(const Value &formatValue, const char *format, StringFormatProgram &uncachedProgram) {
+    size_t formatLength = strlen(format);
+    if (formatLength == 0) {
+        return nullptr;
+    }
+    if ((formatValue.type != VALUE_TYPE_STRING && formatValue.type != VALUE_TYPE_STRING_ASSET) || formatLength > STRING_FORMAT_PROGRAM_MAX_FORMAT_LENGTH) {
+        return compileStringFormat(format, formatLength, uncachedProgram) ? &uncachedProgram : nullptr;
+    }
+    auto &program = g_stringFormatPrograms[((uintptr_t)format >> 2) % STRING_FORMAT_PROGRAM_CACHE_SIZE];
+    if (program.format == format && memcmp(program.formatCopy, format, formatLength + 1) == 0) {
+        return &program;
+    }
+    program.format = nullptr;
+    if (!compileStringFormat(format, formatLength, program)) {
+        return nullptr;
+    }
+    program.format = format;
+    memcpy(program.formatCopy, format, formatLength + 1);
+    return &program;
+}
+static char *prependDecimalDigits(char *end, uint64_t value, uint32_t minDigits) {
+    uint32_t numDigits = getDecimalDigitCount(value);
+    if (numDigits < minDigits) {
+        numDigits = minDigits;
+    }
+    writeDecimalDigits(end - numDigits, value, numDigits);
+    return end - numDigits;
+}
+static bool roundFixedPoint(double value, int precision, uint64_t &result) {
+    double scale = g_powersOf10[precision];
+    double scaled = value * scale;
+    if (!(scaled < 9007199254740992.0)) {
+        return false;
+    }
+    double rounded = nearbyint(scaled);
+    if (fabs(scaled - rounded) == 0.5) {
+        double error = fma(value, scale, -scaled);
+        if (error > 0 && rounded < scaled) {
+            rounded += 1;
+        } else if (error < 0 && rounded > scaled) {
+            rounded -= 1;
+        }
+    }
+    result = (uint64_t)rounded;
+    return true;
+}
+static int runFastStringFormat(const StringFormatProgram &program, const char *format, const Value &b, char *result) {
+    char digits[48];
+    char *digitsEnd = digits + sizeof(digits);
+    char *digitsBegin;
+    bool negative = false;
+    if (program.specifier == 'f' || program.specifier == 'F') {
+        double value = b.isDouble() ? b.getDouble() : (double)b.toFloat();
+        if (!isfinite(value)) {
+            return -1;
+        }
+        negative = signbit(value);
+        uint64_t fixedPoint;
+        if (!roundFixedPoint(fabs(value), program.precision, fixedPoint)) {
+            return -1;
+        }
+        uint64_t scale = (uint64_t)g_powersOf10[program.precision];
+        if (program.precision > 0) {
+            digitsBegin = prependDecimalDigits(digitsEnd, fixedPoint % scale, program.precision);
+            *--digitsBegin = '.';
+            digitsBegin = prependDecimalDigits(digitsBegin, fixedPoint / scale, 1);
+        } else {
+            digitsBegin = prependDecimalDigits(digitsEnd, fixedPoint, 1);
+        }
+    } else if (program.specifier == 'u') {
+        digitsBegin = prependDecimalDigits(digitsEnd, (unsigned int)b.getUInt32(), 1);
+    } else {
+        int value = (int)b.getInt();
+        negative = value < 0;
+        digitsBegin = prependDecimalDigits(digitsEnd, negative ? 0 - (uint64_t)(int64_t)value : (uint64_t)value, 1);
+    }
+    char sign = negative ? '-' : program.sign;
+    int numDigits = (int)(digitsEnd - digitsBegin);
+    int numChars = numDigits + (sign ? 1 : 0);
+    int padding = program.width > numChars ? program.width - numChars : 0;
+    char *p = result;
+    memcpy(p, format, program.prefixLength);
+    p += program.prefixLength;
+    if (padding && !program.leftAlign && !program.zeroPad) {
+        memset(p, ' ', padding);
+        p += padding;
+    }
+    if (sign) {
+        *p++ = sign;
+    }
+    if (padding && program.zeroPad) {
+        memset(p, '0', padding);
+        p += padding;
+    }
+    memcpy(p, digitsBegin, numDigits);
+    p += numDigits;
+    if (padding && program.leftAlign) {
+        memset(p, ' ', padding);
+        p += padding;
+    }
+    *p = 0;
+    return (int)(p - result);
+}
+static void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
+    auto a = stack.pop().getValue();
+    if (a.isError()) {
+        stack.push(a);
+        return;
+    }
+    auto b = stack.pop().getValue();
+    if (b.isError()) {
+        stack.push(b);
+        return;
+    }
+    if (!a.isString()) {
         stack.push(Value::makeError());
         return;
     }
-    int resultStrLen = do_string_format(type, b, NULL, 0, format);
+    const char *format = a.getString();
+    StringFormatProgram uncachedProgram;
+    auto program = getStringFormatProgram(a, format, uncachedProgram);
+    if (!program) {
+        stack.push(Value::makeError());
+        return;
+    }
+    if (program->fast) {
+        char result[128];
+        int resultStrLen = runFastStringFormat(*program, format, b, result);
+        if (resultStrLen >= 0) {
+            stack.push(Value::makeStringRef(result, resultStrLen, 0x1e1227fd));
+            return;
+        }
+    }
+    int resultStrLen = do_string_format(program->type, b, NULL, 0, format);
     char *resultStr = (char *)eez::alloc(resultStrLen + 1, 0x987ee4eb);
-    do_string_format(type, b, resultStr, resultStrLen + 1, format);
+    do_string_format(program->type, b, resultStr, resultStrLen + 1, format);
     stack.push(Value::makeStringRef(resultStr, -1, 0x1e1227fd));
     eez::free(resultStr);
 }
@@ -8615,7 +10883,23 @@ static void do_OPERATION_TYPE_STRING_PAD_START(EvalStack &stack) {
     for (int i = 0; i < n; i++) {
         resultStr[i] = padStr.getString()[i % padStrLen];
     }
-    stack.push(resultValue);
+    stack.push(std::move(resultValue));
+}
+static const char *findSubstring(const char *begin, const char *end, const char *substr, size_t substrLen) {
+    if (substrLen == 0) {
+        return end;
+    }
+    while ((size_t)(end - begin) >= substrLen) {
+        auto p = (const char *)memchr(begin, substr[0], end - begin - substrLen + 1);
+        if (!p) {
+            break;
+        }
+        if (memcmp(p + 1, substr + 1, substrLen - 1) == 0) {
+            return p;
+        }
+        begin = p + 1;
+    }
+    return end;
 }
 static void do_OPERATION_TYPE_STRING_SPLIT(EvalStack &stack) {
     auto strValue = stack.pop().getValue();
@@ -8638,28 +10922,30 @@ static void do_OPERATION_TYPE_STRING_SPLIT(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
-    auto strLen = strlen(str);
-    char *strCopy = (char *)eez::alloc(strLen + 1, 0xea9d0bc0);
-    stringCopy(strCopy, strLen + 1, str);
-    size_t arraySize = 0;
-    char *token = strtok(strCopy, delim);
-    while (token != NULL) {
-        arraySize++;
-        token = strtok(NULL, delim);
+    auto strLen = strValue.getStringLength();
+    auto delimLen = delimValue.getStringLength();
+    auto arrayValue = Value::makeArrayRef(0, defs_v3::ARRAY_TYPE_STRING, 0xe82675d4, 8);
+    if (!arrayValue.isArray()) {
+        stack.push(Value::makeError());
+        return;
     }
-    eez::free(strCopy);
-    strCopy = (char *)eez::alloc(strLen + 1, 0xea9d0bc1);
-    stringCopy(strCopy, strLen + 1, str);
-    auto arrayValue = Value::makeArrayRef(arraySize, VALUE_TYPE_STRING, 0xe82675d4);
-    auto array = arrayValue.getArray();
-    int i = 0;
-    token = strtok(strCopy, delim);
-    while (token != NULL) {
-        array->values[i++] = Value::makeStringRef(token, -1, 0x45209ec0);
-        token = strtok(NULL, delim);
+    const char *strEnd = str + strLen;
+    const char *fieldStart = str;
+    while (true) {
+        const char *fieldEnd = findSubstring(fieldStart, strEnd, delim, delimLen);
+        Value fieldValue = fieldEnd == strEnd ?
+            Value::makeStringSuffixRef(strValue, fieldStart - str, 0x45209ec0) :
+            Value::makeStringRef(fieldStart, fieldEnd - fieldStart, 0x45209ec0);
+        if (!insertArrayElement(arrayValue, arrayValue.getArray()->arraySize, fieldValue)) {
+            stack.push(Value::makeError());
+            return;
+        }
+        if (fieldEnd == strEnd) {
+            break;
+        }
+        fieldStart = fieldEnd + delimLen;
     }
-    eez::free(strCopy);
-    stack.push(arrayValue);
+    stack.push(std::move(arrayValue));
 }
 static void do_OPERATION_TYPE_STRING_FROM_CODE_POINT(EvalStack &stack) {
     Value charCodeValue = stack.pop().getValue();
@@ -8719,13 +11005,46 @@ static void do_OPERATION_TYPE_ARRAY_LENGTH(EvalStack &stack) {
         stack.push(Value(blobRef->len, VALUE_TYPE_UINT32));
         return;
     }
+    uint32_t jsonLength;
+    if (getJsonLength(a, jsonLength)) {
+        stack.push(Value(jsonLength, VALUE_TYPE_UINT32));
+        return;
+    }
     stack.push(Value::makeError());
 }
+// A ref operand with refCounter == 1 is reused as the result and mutated in
+// place. This is only safe because every holder of an array or a SHA-256
+// context owns a counted reference: flow and native variables, Watch and Loop
+// execution states, ArrayElementValue refs and eval stack entries all keep a
+// Value copy, and no engine structure keeps a bare Ref pointer past the current
+// operation.
+static bool isUniqueRef(const Value &value, ValueType type) {
+    return value.type == type && value.refValue->refCounter == 1;
+}
+static Value *getInPlaceRefValue(EvalStack &stack, Value &operand, ValueType type) {
+    if (operand.type == type) {
+        return isUniqueRef(operand, type) ? &operand : nullptr;
+    }
+    if (!stack.inPlaceAssignmentTarget || operand.type != VALUE_TYPE_VALUE_PTR) {
+        return nullptr;
+    }
+    Value *pValue = operand.pValueValue;
+    while (pValue->type == VALUE_TYPE_VALUE_PTR) {
+        pValue = pValue->pValueValue;
+    }
+    if (pValue != stack.inPlaceAssignmentTarget || !isUniqueRef(*pValue, type)) {
+        return nullptr;
+    }
+    return pValue;
+}
+static Value *getInPlaceArrayValue(EvalStack &stack, Value &arrayOperand) {
+    return getInPlaceRefValue(stack, arrayOperand, VALUE_TYPE_ARRAY_REF);
+}
 static void do_OPERATION_TYPE_ARRAY_SLICE(EvalStack &stack) {
     auto numArgs = stack.pop().getInt();
-    auto arrayValue = stack.pop().getValue();
-    if (arrayValue.isError()) {
-        stack.push(arrayValue);
+    auto arrayOperand = stack.pop();
+    if (arrayOperand.isError()) {
+        stack.push(arrayOperand);
         return;
     }
     int from = 0;
@@ -8762,6 +11081,17 @@ static void do_OPERATION_TYPE_ARRAY_SLICE(EvalStack &stack) {
             to = 0;
         }
     }
+    auto pInPlaceArrayValue = getInPlaceArrayValue(stack, arrayOperand);
+    if (pInPlaceArrayValue) {
+        auto arraySize = pInPlaceArrayValue->getArray()->arraySize;
+        auto inPlaceTo = to == -1 ? arraySize : (uint32_t)to;
+        if ((uint32_t)from <= inPlaceTo && inPlaceTo <= arraySize) {
+            sliceArrayElements(*pInPlaceArrayValue, from, inPlaceTo);
+            stack.push(*pInPlaceArrayValue);
+            return;
+        }
+    }
+    auto arrayValue = arrayOperand.getValue();
     if (!arrayValue.isArray()) {
         stack.push(Value::makeError());
         return;
@@ -8777,10 +11107,10 @@ static void do_OPERATION_TYPE_ARRAY_SLICE(EvalStack &stack) {
     auto size = to - from;
     auto resultArrayValue = Value::makeArrayRef(size, array->arrayType, 0xe2d78c65);
     auto resultArray = resultArrayValue.getArray();
-    for (int elementIndex = from; elementIndex < to && elementIndex < (int)array->arraySize; elementIndex++) {
-        resultArray->values[elementIndex - from] = array->values[elementIndex];
+    if (from < (int)array->arraySize) {
+        copyArrayElements(resultArray->values, array->values + from, (uint32_t)((to < (int)array->arraySize ? to : (int)array->arraySize) - from));
     }
-    stack.push(resultArrayValue);
+    stack.push(std::move(resultArrayValue));
 }
 static void do_OPERATION_TYPE_ARRAY_ALLOCATE(EvalStack &stack) {
     auto sizeValue = stack.pop();
@@ -8795,12 +11125,12 @@ static void do_OPERATION_TYPE_ARRAY_ALLOCATE(EvalStack &stack) {
         return;
     }
     auto resultArrayValue = Value::makeArrayRef(size, defs_v3::ARRAY_TYPE_ANY, 0xe2d78c65);
-    stack.push(resultArrayValue);
+    stack.push(std::move(resultArrayValue));
 }
 static void do_OPERATION_TYPE_ARRAY_APPEND(EvalStack &stack) {
-    auto arrayValue = stack.pop().getValue();
-    if (arrayValue.isError()) {
-        stack.push(arrayValue);
+    auto arrayOperand = stack.pop();
+    if (arrayOperand.isError()) {
+        stack.push(arrayOperand);
         return;
     }
     auto value = stack.pop().getValue();
@@ -8808,6 +11138,16 @@ static void do_OPERATION_TYPE_ARRAY_APPEND(EvalStack &stack) {
         stack.push(value);
         return;
     }
+    auto pInPlaceArrayValue = getInPlaceArrayValue(stack, arrayOperand);
+    if (pInPlaceArrayValue) {
+        if (insertArrayElement(*pInPlaceArrayValue, pInPlaceArrayValue->getArray()->arraySize, value)) {
+            stack.push(*pInPlaceArrayValue);
+        } else {
+            stack.push(Value::makeError());
+        }
+        return;
+    }
+    auto arrayValue = arrayOperand.getValue();
     if (!arrayValue.isArray()) {
         stack.push(Value::makeError());
         return;
@@ -8815,16 +11155,14 @@ static void do_OPERATION_TYPE_ARRAY_APPEND(EvalStack &stack) {
     auto array = arrayValue.getArray();
     auto resultArrayValue = Value::makeArrayRef(array->arraySize + 1, array->arrayType, 0x664c3199);
     auto resultArray = resultArrayValue.getArray();
-    for (uint32_t elementIndex = 0; elementIndex < array->arraySize; elementIndex++) {
-        resultArray->values[elementIndex] = array->values[elementIndex];
-    }
+    copyArrayElements(resultArray->values, array->values, array->arraySize);
     resultArray->values[array->arraySize] = value;
-    stack.push(resultArrayValue);
+    stack.push(std::move(resultArrayValue));
 }
 static void do_OPERATION_TYPE_ARRAY_INSERT(EvalStack &stack) {
-    auto arrayValue = stack.pop().getValue();
-    if (arrayValue.isError()) {
-        stack.push(arrayValue);
+    auto arrayOperand = stack.pop();
+    if (arrayOperand.isError()) {
+        stack.push(arrayOperand);
         return;
     }
     auto positionValue = stack.pop().getValue();
@@ -8843,6 +11181,16 @@ static void do_OPERATION_TYPE_ARRAY_INSERT(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
+    auto pInPlaceArrayValue = getInPlaceArrayValue(stack, arrayOperand);
+    if (pInPlaceArrayValue) {
+        if (insertArrayElement(*pInPlaceArrayValue, position < 0 ? 0 : (uint32_t)position, value)) {
+            stack.push(*pInPlaceArrayValue);
+        } else {
+            stack.push(Value::makeError());
+        }
+        return;
+    }
+    auto arrayValue = arrayOperand.getValue();
     if (!arrayValue.isArray()) {
         stack.push(Value::makeError());
         return;
@@ -8855,19 +11203,15 @@ static void do_OPERATION_TYPE_ARRAY_INSERT(EvalStack &stack) {
     } else if ((uint32_t)position > array->arraySize) {
         position = array->arraySize;
     }
-    for (uint32_t elementIndex = 0; (int)elementIndex < position; elementIndex++) {
-        resultArray->values[elementIndex] = array->values[elementIndex];
-    }
+    copyArrayElements(resultArray->values, array->values, position);
     resultArray->values[position] = value;
-    for (uint32_t elementIndex = position; elementIndex < array->arraySize; elementIndex++) {
-        resultArray->values[elementIndex + 1] = array->values[elementIndex];
-    }
-    stack.push(resultArrayValue);
+    copyArrayElements(resultArray->values + position + 1, array->values + position, array->arraySize - position);
+    stack.push(std::move(resultArrayValue));
 }
 static void do_OPERATION_TYPE_ARRAY_REMOVE(EvalStack &stack) {
-    auto arrayValue = stack.pop().getValue();
-    if (arrayValue.isError()) {
-        stack.push(arrayValue);
+    auto arrayOperand = stack.pop();
+    if (arrayOperand.isError()) {
+        stack.push(arrayOperand);
         return;
     }
     auto positionValue = stack.pop().getValue();
@@ -8881,6 +11225,17 @@ static void do_OPERATION_TYPE_ARRAY_REMOVE(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
+    auto pInPlaceArrayValue = getInPlaceArrayValue(stack, arrayOperand);
+    if (pInPlaceArrayValue) {
+        if (position >= 0 && position < (int32_t)pInPlaceArrayValue->getArray()->arraySize) {
+            removeArrayElement(*pInPlaceArrayValue, position);
+            stack.push(*pInPlaceArrayValue);
+        } else {
+            stack.push(Value::makeError());
+        }
+        return;
+    }
+    auto arrayValue = arrayOperand.getValue();
     if (!arrayValue.isArray()) {
         stack.push(Value::makeError());
         return;
@@ -8889,57 +11244,429 @@ static void do_OPERATION_TYPE_ARRAY_REMOVE(EvalStack &stack) {
     if (position >= 0 && position < (int32_t)array->arraySize) {
         auto resultArrayValue = Value::makeArrayRef(array->arraySize - 1, array->arrayType, 0x40e9bb4b);
         auto resultArray = resultArrayValue.getArray();
-        for (uint32_t elementIndex = 0; (int)elementIndex < position; elementIndex++) {
-            resultArray->values[elementIndex] = array->values[elementIndex];
-        }
-        for (uint32_t elementIndex = position + 1; elementIndex < array->arraySize; elementIndex++) {
-            resultArray->values[elementIndex - 1] = array->values[elementIndex];
-        }
-        stack.push(resultArrayValue);
+        copyArrayElements(resultArray->values, array->values, position);
+        copyArrayElements(resultArray->values + position, array->values + position + 1, array->arraySize - position - 1);
+        stack.push(std::move(resultArrayValue));
     } else {
         stack.push(Value::makeError());
     }
 }
 static void do_OPERATION_TYPE_ARRAY_CLONE(EvalStack &stack) {
-    auto arrayValue = stack.pop().getValue();
+    auto arrayOperand = stack.pop();
+    if (isUniqueArrayRef(arrayOperand) && !hasArrayElements(arrayOperand)) {
+        stack.push(std::move(arrayOperand));
+        return;
+    }
+    auto arrayValue = arrayOperand.getValue();
     if (arrayValue.isError()) {
         stack.push(arrayValue);
         return;
     }
     auto resultArray = arrayValue.clone();
-    stack.push(resultArray);
+    stack.push(std::move(resultArray));
+}
+static inline bool getArrayElementNumber(const Value &value, double &number) {
+    switch (value.type) {
+    case VALUE_TYPE_DOUBLE:
+        number = value.doubleValue;
+        return true;
+    case VALUE_TYPE_FLOAT:
+        number = value.floatValue;
+        return true;
+    case VALUE_TYPE_INT32:
+        number = value.int32Value;
+        return true;
+    default:
+        if (value.isInt32OrLess() || value.isInt64()) {
+            number = value.toDouble();
+            return true;
+        }
+        return false;
+    }
+}
+static const ArrayValue *popNumberArray(EvalStack &stack, Value &arrayValue) {
+    arrayValue = stack.pop().getValue();
+    if (arrayValue.isError()) {
+        stack.push(arrayValue);
+        return nullptr;
+    }
+    if (!arrayValue.isArray()) {
+        stack.push(Value::makeError());
+        return nullptr;
+    }
+    auto array = arrayValue.getArray();
+    double number;
+    for (uint32_t i = 0; i < array->arraySize; i++) {
+        if (!getArrayElementNumber(array->values[i], number)) {
+            stack.push(Value::makeError());
+            return nullptr;
+        }
+    }
+    return array;
+}
+static double getArrayNumberSum(const ArrayValue *array) {
+    double sum[4] = { 0, 0, 0, 0 };
+    uint32_t n = array->arraySize;
+    uint32_t i = 0;
+    double number[4] = { 0, 0, 0, 0 };
+    for (; i + 4 <= n; i += 4) {
+        getArrayElementNumber(array->values[i], number[0]);
+        getArrayElementNumber(array->values[i + 1], number[1]);
+        getArrayElementNumber(array->values[i + 2], number[2]);
+        getArrayElementNumber(array->values[i + 3], number[3]);
+        sum[0] += number[0];
+        sum[1] += number[1];
+        sum[2] += number[2];
+        sum[3] += number[3];
+    }
+    for (; i < n; i++) {
+        getArrayElementNumber(array->values[i], number[0]);
+        sum[0] += number[0];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+static int getArrayExtremeIndex(const ArrayValue *array, bool max) {
+    if (array->arraySize == 0) {
+        return -1;
+    }
+    int extremeIndex = 0;
+    double extreme = 0;
+    getArrayElementNumber(array->values[0], extreme);
+    for (uint32_t i = 1; i < array->arraySize; i++) {
+        double number = 0;
+        getArrayElementNumber(array->values[i], number);
+        if (max ? number > extreme : number < extreme) {
+            extreme = number;
+            extremeIndex = i;
+        }
+    }
+    return extremeIndex;
+}
+static void do_OPERATION_TYPE_ARRAY_SUM(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    bool integers = true;
+    int64_t integerSum = 0;
+    for (uint32_t i = 0; i < array->arraySize && integers; i++) {
+        auto &value = array->values[i];
+        if (value.isInt32OrLess()) {
+            integerSum += value.toInt64();
+        } else {
+            integers = false;
+        }
+    }
+    if (integers && integerSum >= INT32_MIN && integerSum <= INT32_MAX) {
+        stack.push(Value((int)integerSum, VALUE_TYPE_INT32));
+        return;
+    }
+    stack.push(Value(getArrayNumberSum(array), VALUE_TYPE_DOUBLE));
+}
+static void do_OPERATION_TYPE_ARRAY_MIN(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    auto index = getArrayExtremeIndex(array, false);
+    stack.push(index != -1 ? array->values[index] : Value());
+}
+static void do_OPERATION_TYPE_ARRAY_MAX(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    auto index = getArrayExtremeIndex(array, true);
+    stack.push(index != -1 ? array->values[index] : Value());
+}
+static void do_OPERATION_TYPE_ARRAY_MEAN(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    stack.push(Value(array->arraySize > 0 ? getArrayNumberSum(array) / array->arraySize : NAN, VALUE_TYPE_DOUBLE));
+}
+static void do_OPERATION_TYPE_ARRAY_STDDEV(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    uint32_t n = array->arraySize;
+    if (n == 0) {
+        stack.push(Value(NAN, VALUE_TYPE_DOUBLE));
+        return;
+    }
+    double mean = getArrayNumberSum(array) / n;
+    double sum[2] = { 0, 0 };
+    uint32_t i = 0;
+    double number[2] = { 0, 0 };
+    for (; i + 2 <= n; i += 2) {
+        getArrayElementNumber(array->values[i], number[0]);
+        getArrayElementNumber(array->values[i + 1], number[1]);
+        number[0] -= mean;
+        number[1] -= mean;
+        sum[0] += number[0] * number[0];
+        sum[1] += number[1] * number[1];
+    }
+    if (i < n) {
+        getArrayElementNumber(array->values[i], number[0]);
+        number[0] -= mean;
+        sum[0] += number[0] * number[0];
+    }
+    stack.push(Value(sqrt((sum[0] + sum[1]) / n), VALUE_TYPE_DOUBLE));
+}
+static void do_OPERATION_TYPE_ARRAY_ARG_MIN(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    stack.push(Value(getArrayExtremeIndex(array, false), VALUE_TYPE_INT32));
+}
+static void do_OPERATION_TYPE_ARRAY_ARG_MAX(EvalStack &stack) {
+    Value arrayValue;
+    auto array = popNumberArray(stack, arrayValue);
+    if (!array) {
+        return;
+    }
+    stack.push(Value(getArrayExtremeIndex(array, true), VALUE_TYPE_INT32));
+}
+static inline double addDoubles(double a, double b) { return a + b; }
+static inline double subDoubles(double a, double b) { return a - b; }
+static inline double mulDoubles(double a, double b) { return a * b; }
+static inline double divDoubles(double a, double b) { return a / b; }
+template <Value (*operation)(const Value &, const Value &), double (*doubleOperation)(double, double)>
+static void doArrayElementwiseOperation(EvalStack &stack, bool integerToDouble) {
+    auto arrayOperand = stack.pop();
+    if (arrayOperand.isError()) {
+        stack.push(arrayOperand);
+        return;
+    }
+    auto operandValue = stack.pop().getValue();
+    if (operandValue.isError()) {
+        stack.push(operandValue);
+        return;
+    }
+    bool inPlace = isUniqueArrayRef(arrayOperand);
+    auto arrayValue = arrayOperand.getValue();
+    if (!arrayValue.isArray()) {
+        stack.push(Value::makeError());
+        return;
+    }
+    auto array = arrayValue.getArray();
+    const Value *operands = &operandValue;
+    uint32_t operandStep = 0;
+    if (operandValue.isArray()) {
+        auto operandArray = operandValue.getArray();
+        if (operandArray->arraySize != array->arraySize) {
+            stack.push(Value::makeError());
+            return;
+        }
+        operands = operandArray->values;
+        operandStep = 1;
+    }
+    auto arrayType = integerToDouble && array->arrayType == defs_v3::ARRAY_TYPE_INTEGER ? defs_v3::ARRAY_TYPE_DOUBLE : array->arrayType;
+    Value resultArrayValue;
+    if (inPlace) {
+        resultArrayValue = arrayValue;
+    } else {
+        resultArrayValue = Value::makeArrayRef(array->arraySize, arrayType, 0x1d5e93b7);
+    }
+    auto resultArray = resultArrayValue.getArray();
+    resultArray->arrayType = arrayType;
+    auto values = array->values;
+    auto resultValues = resultArray->values;
+    for (uint32_t i = 0, j = 0; i < array->arraySize; i++, j += operandStep) {
+        double a;
+        double b;
+        if ((values[i].type == VALUE_TYPE_DOUBLE || operands[j].type == VALUE_TYPE_DOUBLE) && getArrayElementNumber(values[i], a) && getArrayElementNumber(operands[j], b)) {
+            resultValues[i] = Value(doubleOperation(a, b), VALUE_TYPE_DOUBLE);
+            continue;
+        }
+        auto result = operation(values[i], operands[j]);
+        if (result.isError()) {
+            stack.push(result);
+            return;
+        }
+        resultValues[i] = result;
+    }
+    stack.push(std::move(resultArrayValue));
+}
+static void do_OPERATION_TYPE_ARRAY_ADD(EvalStack &stack) {
+    doArrayElementwiseOperation<op_add, addDoubles>(stack, false);
+}
+static void do_OPERATION_TYPE_ARRAY_SUB(EvalStack &stack) {
+    doArrayElementwiseOperation<op_sub, subDoubles>(stack, false);
+}
+static void do_OPERATION_TYPE_ARRAY_MUL(EvalStack &stack) {
+    doArrayElementwiseOperation<op_mul, mulDoubles>(stack, false);
+}
+static void do_OPERATION_TYPE_ARRAY_DIV(EvalStack &stack) {
+    doArrayElementwiseOperation<op_div, divDoubles>(stack, true);
 }
 static void do_OPERATION_TYPE_LVGL_METER_TICK_INDEX(EvalStack &stack) {
     stack.push(g_eezFlowLvlgMeterTickIndex);
 }
-static void do_OPERATION_TYPE_CRYPTO_SHA256(EvalStack &stack) {
 #if EEZ_FOR_LVGL_SHA256_OPTION
-    auto value = stack.pop().getValue();
-    if (value.isError()) {
-        stack.push(value);
-        return;
+struct Sha256ContextRef : public Ref {
+    SHA256_CTX ctx;
+};
+static Value makeSha256ContextRef(const SHA256_CTX *ctx, uint32_t id) {
+    auto sha256ContextRef = ObjectAllocator<Sha256ContextRef>::allocate(id);
+    if (sha256ContextRef == nullptr) {
+        return Value(0, VALUE_TYPE_NULL);
     }
-    const uint8_t *data;
-    uint32_t dataLen;
+    if (ctx) {
+        sha256ContextRef->ctx = *ctx;
+    } else {
+        sha256_init(&sha256ContextRef->ctx);
+    }
+    sha256ContextRef->refCounter = 1;
+    Value value;
+    value.type = VALUE_TYPE_SHA256_CONTEXT;
+    value.options = VALUE_OPTIONS_REF;
+    value.refValue = sha256ContextRef;
+    return value;
+}
+static bool getSha256Data(const Value &value, const uint8_t *&data, uint32_t &dataLen) {
     if (value.isString()) {
         const char *str = value.getString();
         data = (uint8_t *)str;
         dataLen = strlen(str);
-    } else if (value.isBlob()) {
+        return true;
+    }
+    if (value.isBlob()) {
         auto blobRef = value.getBlob();
         data = blobRef->blob;
         dataLen = blobRef->len;
-    } else {
+        return true;
+    }
+    return false;
+}
+#endif
+static void do_OPERATION_TYPE_CRYPTO_SHA256(EvalStack &stack) {
+#if EEZ_FOR_LVGL_SHA256_OPTION
+    auto value = stack.pop().getValue();
+    if (value.isError()) {
+        stack.push(value);
+        return;
+    }
+    const uint8_t *data;
+    uint32_t dataLen;
+    if (!getSha256Data(value, data, dataLen)) {
         stack.push(Value::makeError());
         return;
     }
     BYTE buf[SHA256_BLOCK_SIZE];
     SHA256_CTX ctx;
     sha256_init(&ctx);
-	sha256_update(&ctx, data, dataLen);
-	sha256_final(&ctx, buf);
+    sha256_update(&ctx, data, dataLen);
+    sha256_final(&ctx, buf);
     auto result = Value::makeBlobRef(buf, SHA256_BLOCK_SIZE, 0x1f0c0c0c);
-    stack.push(result);
+    stack.push(std::move(result));
+#else
+    stack.push(Value::makeError());
+#endif
+}
+static void do_OPERATION_TYPE_CRYPTO_SHA256_INIT(EvalStack &stack) {
+#if EEZ_FOR_LVGL_SHA256_OPTION
+    stack.push(makeSha256ContextRef(nullptr, 0x6b1d2e41));
+#else
+    stack.push(Value::makeError());
+#endif
+}
+static void do_OPERATION_TYPE_CRYPTO_SHA256_UPDATE(EvalStack &stack) {
+#if EEZ_FOR_LVGL_SHA256_OPTION
+    auto numArgs = stack.pop().getInt();
+    auto contextOperand = stack.pop();
+    auto value = stack.pop().getValue();
+    if (contextOperand.isError()) {
+        stack.push(contextOperand);
+        return;
+    }
+    if (value.isError()) {
+        stack.push(value);
+        return;
+    }
+    const uint8_t *data;
+    uint32_t dataLen;
+    if (!getSha256Data(value, data, dataLen)) {
+        stack.push(Value::makeError());
+        return;
+    }
+    uint32_t offset = 0;
+    if (numArgs > 2) {
+        auto offsetValue = stack.pop().getValue();
+        if (offsetValue.isError()) {
+            stack.push(offsetValue);
+            return;
+        }
+        int err;
+        auto from = offsetValue.toInt32(&err);
+        if (err || from < 0) {
+            stack.push(Value::makeError());
+            return;
+        }
+        offset = MIN((uint32_t)from, dataLen);
+    }
+    uint32_t length = dataLen - offset;
+    if (numArgs > 3) {
+        auto lengthValue = stack.pop().getValue();
+        if (lengthValue.isError()) {
+            stack.push(lengthValue);
+            return;
+        }
+        int err;
+        auto count = lengthValue.toInt32(&err);
+        if (err || count < 0) {
+            stack.push(Value::makeError());
+            return;
+        }
+        length = MIN((uint32_t)count, length);
+    }
+    auto pInPlaceContextValue = getInPlaceRefValue(stack, contextOperand, VALUE_TYPE_SHA256_CONTEXT);
+    if (pInPlaceContextValue) {
+        sha256_update(&((Sha256ContextRef *)pInPlaceContextValue->refValue)->ctx, data + offset, length);
+        stack.push(*pInPlaceContextValue);
+        return;
+    }
+    auto contextValue = contextOperand.getValue();
+    if (contextValue.type != VALUE_TYPE_SHA256_CONTEXT) {
+        stack.push(Value::makeError());
+        return;
+    }
+    auto result = makeSha256ContextRef(&((Sha256ContextRef *)contextValue.refValue)->ctx, 0x6b1d2e42);
+    if (result.type != VALUE_TYPE_SHA256_CONTEXT) {
+        stack.push(Value::makeError());
+        return;
+    }
+    sha256_update(&((Sha256ContextRef *)result.refValue)->ctx, data + offset, length);
+    stack.push(std::move(result));
+#else
+    stack.push(Value::makeError());
+#endif
+}
+static void do_OPERATION_TYPE_CRYPTO_SHA256_FINAL(EvalStack &stack) {
+#if EEZ_FOR_LVGL_SHA256_OPTION
+    auto contextValue = stack.pop().getValue();
+    if (contextValue.isError()) {
+        stack.push(contextValue);
+        return;
+    }
+    if (contextValue.type != VALUE_TYPE_SHA256_CONTEXT) {
+        stack.push(Value::makeError());
+        return;
+    }
+    BYTE buf[SHA256_BLOCK_SIZE];
+    SHA256_CTX ctx = ((Sha256ContextRef *)contextValue.refValue)->ctx;
+    sha256_final(&ctx, buf);
+    auto result = Value::makeBlobRef(buf, SHA256_BLOCK_SIZE, 0x6b1d2e43);
+    stack.push(std::move(result));
 #else
     stack.push(Value::makeError());
 #endif
@@ -8957,16 +11684,50 @@ static void do_OPERATION_TYPE_BLOB_ALLOCATE(EvalStack &stack) {
         return;
     }
     auto result = Value::makeBlobRef(nullptr, size, 0xd3de43f1);
-    stack.push(result);
+    stack.push(std::move(result));
 }
 static void do_OPERATION_TYPE_BLOB_TO_STRING(EvalStack &stack) {
     stack.push(Value::makeError());
 }
+static Value getJsonOperand(EvalStack &stack) {
+    auto jsonValue = stack.pop().getValue();
+    if (jsonValue.isString()) {
+        return parseJsonString(jsonValue);
+    }
+    return jsonValue;
+}
 static void do_OPERATION_TYPE_JSON_GET(EvalStack &stack) {
-    stack.push(Value::makeError());
+    auto jsonValue = getJsonOperand(stack);
+    if (jsonValue.isError()) {
+        stack.push(jsonValue);
+        return;
+    }
+    auto propertyValue = stack.pop().getValue();
+    if (propertyValue.isError()) {
+        stack.push(propertyValue);
+        return;
+    }
+    if (!isJsonRef(jsonValue)) {
+        stack.push(Value::makeError());
+        return;
+    }
+    if (propertyValue.isString()) {
+        stack.push(getJsonPath(jsonValue, propertyValue.getString()));
+    } else {
+        stack.push(getJsonProperty(jsonValue, propertyValue));
+    }
 }
 static void do_OPERATION_TYPE_JSON_CLONE(EvalStack &stack) {
-    stack.push(Value::makeError());
+    auto jsonValue = stack.pop().getValue();
+    if (jsonValue.isString()) {
+        stack.push(parseJsonString(jsonValue));
+        return;
+    }
+    if (!jsonValue.isError() && !jsonValue.isJson()) {
+        stack.push(Value::makeError());
+        return;
+    }
+    stack.push(std::move(jsonValue));
 }
 static void do_OPERATION_TYPE_EVENT_GET_CODE(EvalStack &stack) {
     auto eventValue = stack.pop().getValue();
@@ -9123,7 +11884,22 @@ EvalOperation g_evalOperations[] = {
     do_OPERATION_TYPE_BLOB_TO_STRING,
     do_OPERATION_TYPE_FLOW_THEMES,
     do_OPERATION_TYPE_FLOW_GET_THEME_COLOR,
+    do_OPERATION_TYPE_ARRAY_SUM,
+    do_OPERATION_TYPE_ARRAY_MIN,
+    do_OPERATION_TYPE_ARRAY_MAX,
+    do_OPERATION_TYPE_ARRAY_MEAN,
+    do_OPERATION_TYPE_ARRAY_STDDEV,
+    do_OPERATION_TYPE_ARRAY_ARG_MIN,
+    do_OPERATION_TYPE_ARRAY_ARG_MAX,
+    do_OPERATION_TYPE_ARRAY_ADD,
+    do_OPERATION_TYPE_ARRAY_SUB,
+    do_OPERATION_TYPE_ARRAY_MUL,
+    do_OPERATION_TYPE_ARRAY_DIV,
+    do_OPERATION_TYPE_CRYPTO_SHA256_INIT,
+    do_OPERATION_TYPE_CRYPTO_SHA256_UPDATE,
+    do_OPERATION_TYPE_CRYPTO_SHA256_FINAL,
 };
+static_assert(sizeof(g_evalOperations) / sizeof(EvalOperation) == defs_v3::OPERATION_TYPE_CRYPTO_SHA256_FINAL + 1, "g_evalOperations must have one entry per operation type");
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -9226,6 +12002,7 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 			sizeof(FlowState) +
 			nValues * sizeof(Value) +
 			flow->components.count * sizeof(ComponenentExecutionState *) +
+			flow->components.count * sizeof(unsigned) +
 			flow->components.count * sizeof(bool),
 			0x4c3b6ef5
 		)
@@ -9272,7 +12049,10 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
     flowState->nextSibling = nullptr;
 	flowState->values = (Value *)(flowState + 1);
 	flowState->componenentExecutionStates = (ComponenentExecutionState **)(flowState->values + nValues);
-    flowState->componenentAsyncStates = (bool *)(flowState->componenentExecutionStates + flow->components.count);
+    flowState->componenentQueuedTasks = (unsigned *)(flowState->componenentExecutionStates + flow->components.count);
+    flowState->componenentAsyncStates = (bool *)(flowState->componenentQueuedTasks + flow->components.count);
+    flowState->firstQueueTask = nullptr;
+    flowState->lastQueueTask = nullptr;
 	for (unsigned i = 0; i < nValues; i++) {
 		new (flowState->values + i) Value();
 	}
@@ -9286,6 +12066,7 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 	}
 	for (unsigned i = 0; i < flow->components.count; i++) {
 		flowState->componenentExecutionStates[i] = nullptr;
+		flowState->componenentQueuedTasks[i] = 0;
 		flowState->componenentAsyncStates[i] = false;
 	}
 	onFlowStateCreated(flowState);
@@ -9375,6 +12156,7 @@ void freeFlowState(FlowState *flowState) {
 	}
     removeTasksFromQueueForFlowState(flowState);
     removeWatchesForFlowState(flowState);
+    removeTimersForFlowState(flowState);
     freeAllChildrenFlowStates(flowState->firstChild);
 	onFlowStateDestroyed(flowState);
 	flowState->~FlowState();
@@ -9428,7 +12210,11 @@ void propagateValue(FlowState *flowState, unsigned componentIndex, unsigned outp
     resetSequenceInputs(flowState);
 	auto component = flowState->flow->components[componentIndex];
 	auto componentOutput = component->outputs[outputIndex];
-    auto value2 = value.getValue();
+    Value indirectValue;
+    if (value.isIndirectValueType()) {
+        indirectValue = value.getValue();
+    }
+    const Value &value2 = value.isIndirectValueType() ? indirectValue : value;
 	for (unsigned connectionIndex = 0; connectionIndex < componentOutput->connections.count; connectionIndex++) {
 		auto connection = componentOutput->connections[connectionIndex];
 		auto pValue = &flowState->values[connection->targetInputIndex];
@@ -9460,6 +12246,9 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
 	} else {
 		Value *pDstValue;
         uint32_t dstValueType = VALUE_TYPE_UNDEFINED;
+        if (dstValue.getType() != VALUE_TYPE_VALUE_PTR) {
+            markAllWatchesDirty();
+        }
         if (dstValue.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
             auto arrayElementValue = (ArrayElementValue *)dstValue.refValue;
             if (arrayElementValue->arrayValue.isBlob()) {
@@ -9513,6 +12302,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
             }
             if (pDstValue->type == VALUE_TYPE_VALUE_PTR) {
                 onValueChanged(pDstValue);
+                onWatchedValueChanged(pDstValue);
                 pDstValue = pDstValue->pValueValue;
             } else {
                 break;
@@ -9520,6 +12310,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
         }
         if (assignValue(*pDstValue, srcValue, dstValueType)) {
             onValueChanged(pDstValue);
+            onWatchedValueChanged(pDstValue);
         } else {
             char errorMessage[100];
             snprintf(errorMessage, sizeof(errorMessage), "Can not assign %s to %s\n",
@@ -9759,53 +12550,117 @@ namespace flow {
 #if !defined(EEZ_FLOW_QUEUE_SIZE)
 #define EEZ_FLOW_QUEUE_SIZE 1000
 #endif
+#if !defined(EEZ_FLOW_QUEUE_SEGMENT_SIZE)
+#define EEZ_FLOW_QUEUE_SEGMENT_SIZE 128
+#endif
+#if !defined(EEZ_FLOW_QUEUE_MAX_SIZE)
+#define EEZ_FLOW_QUEUE_MAX_SIZE 100000
+#endif
 static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
-static struct {
+static const unsigned QUEUE_SEGMENT_SIZE = EEZ_FLOW_QUEUE_SEGMENT_SIZE;
+static const unsigned QUEUE_MAX_SIZE = EEZ_FLOW_QUEUE_MAX_SIZE;
+struct QueueTask {
 	FlowState *flowState;
 	unsigned componentIndex;
     bool continuousTask;
-} g_queue[QUEUE_SIZE];
+    QueueTask *nextInFlowState;
+};
+struct QueueSegment {
+    QueueSegment *next;
+    QueueTask tasks[QUEUE_SEGMENT_SIZE];
+};
+static QueueSegment *g_queueFirstSegment;
+static QueueSegment *g_queueLastSegment;
+static QueueSegment *g_queueSpareSegments;
+static unsigned g_queueNumSegments;
 static unsigned g_queueHead;
 static unsigned g_queueTail;
+static unsigned g_queueSize;
 static unsigned g_queueMax;
-static bool g_queueIsFull = false;
 unsigned g_numNonContinuousTaskInQueue;
+static QueueSegment *allocateQueueSegment() {
+    QueueSegment *segment = g_queueSpareSegments;
+    if (segment) {
+        g_queueSpareSegments = segment->next;
+    } else {
+        segment = (QueueSegment *)alloc(sizeof(QueueSegment), 0x6f1d2a3c);
+        if (!segment) {
+            return nullptr;
+        }
+    }
+    segment->next = nullptr;
+    g_queueNumSegments++;
+    return segment;
+}
+static void releaseQueueSegment(QueueSegment *segment) {
+    g_queueNumSegments--;
+    if (g_queueNumSegments * QUEUE_SEGMENT_SIZE < QUEUE_SIZE) {
+        segment->next = g_queueSpareSegments;
+        g_queueSpareSegments = segment;
+    } else {
+        free(segment);
+    }
+}
+static void freeQueueSegments(QueueSegment *segment) {
+    while (segment) {
+        auto next = segment->next;
+        free(segment);
+        segment = next;
+    }
+}
 void queueReset() {
+    freeQueueSegments(g_queueFirstSegment);
+    freeQueueSegments(g_queueSpareSegments);
+    g_queueFirstSegment = nullptr;
+    g_queueLastSegment = nullptr;
+    g_queueSpareSegments = nullptr;
+    g_queueNumSegments = 0;
 	g_queueHead = 0;
 	g_queueTail = 0;
+	g_queueSize = 0;
 	g_queueMax  = 0;
-	g_queueIsFull = false;
     g_numNonContinuousTaskInQueue = 0;
 }
 size_t getQueueSize() {
-	if (g_queueHead == g_queueTail) {
-		if (g_queueIsFull) {
-			return QUEUE_SIZE;
-		}
-		return 0;
-	}
-	if (g_queueHead < g_queueTail) {
-		return g_queueTail - g_queueHead;
-	}
-	return QUEUE_SIZE - g_queueHead + g_queueTail;
+	return g_queueSize;
 }
 size_t getMaxQueueSize() {
 	return g_queueMax;
 }
 bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex, bool continuousTask) {
-	if (g_queueIsFull) {
+    if (g_queueSize >= QUEUE_MAX_SIZE) {
         throwError(flowState, componentIndex, "Execution queue is full\n");
-		return false;
-	}
-	g_queue[g_queueTail].flowState = flowState;
-	g_queue[g_queueTail].componentIndex = componentIndex;
-    g_queue[g_queueTail].continuousTask = continuousTask;
-	g_queueTail = (g_queueTail + 1) % QUEUE_SIZE;
-	if (g_queueHead == g_queueTail) {
-		g_queueIsFull = true;
-	}
-	size_t queueSize = getQueueSize();
-	g_queueMax = g_queueMax < queueSize ? queueSize : g_queueMax;
+        return false;
+    }
+    if (!g_queueLastSegment || g_queueTail == QUEUE_SEGMENT_SIZE) {
+        auto segment = allocateQueueSegment();
+        if (!segment) {
+            throwError(flowState, componentIndex, "Out of memory while growing execution queue\n");
+            return false;
+        }
+        if (g_queueLastSegment) {
+            g_queueLastSegment->next = segment;
+        } else {
+            g_queueFirstSegment = segment;
+            g_queueHead = 0;
+        }
+        g_queueLastSegment = segment;
+        g_queueTail = 0;
+    }
+    auto task = &g_queueLastSegment->tasks[g_queueTail++];
+	task->flowState = flowState;
+	task->componentIndex = componentIndex;
+    task->continuousTask = continuousTask;
+    task->nextInFlowState = nullptr;
+    if (flowState->lastQueueTask) {
+        flowState->lastQueueTask->nextInFlowState = task;
+    } else {
+        flowState->firstQueueTask = task;
+    }
+    flowState->lastQueueTask = task;
+    flowState->componenentQueuedTasks[componentIndex]++;
+	g_queueSize++;
+	g_queueMax = g_queueMax < g_queueSize ? g_queueSize : g_queueMax;
     if (!continuousTask) {
         ++g_numNonContinuousTaskInQueue;
 	    onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
@@ -9814,55 +12669,167 @@ bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceCompone
 	return true;
 }
 bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+	if (g_queueSize == 0) {
 		return false;
 	}
-	flowState = g_queue[g_queueHead].flowState;
-	componentIndex = g_queue[g_queueHead].componentIndex;
-    continuousTask = g_queue[g_queueHead].continuousTask;
+    auto task = &g_queueFirstSegment->tasks[g_queueHead];
+	flowState = task->flowState;
+	componentIndex = task->componentIndex;
+    continuousTask = task->continuousTask;
 	return true;
 }
 void removeNextTaskFromQueue() {
-	auto flowState = g_queue[g_queueHead].flowState;
+    auto task = &g_queueFirstSegment->tasks[g_queueHead];
+	auto flowState = task->flowState;
+    if (flowState) {
+        flowState->firstQueueTask = task->nextInFlowState;
+        if (!flowState->firstQueueTask) {
+            flowState->lastQueueTask = nullptr;
+        }
+        flowState->componenentQueuedTasks[task->componentIndex]--;
+    }
     decRefCounterForFlowState(flowState);
-    auto continuousTask = g_queue[g_queueHead].continuousTask;
-	g_queueHead = (g_queueHead + 1) % QUEUE_SIZE;
-	g_queueIsFull = false;
+    auto continuousTask = task->continuousTask;
+    g_queueSize--;
+    if (++g_queueHead == QUEUE_SEGMENT_SIZE) {
+        auto segment = g_queueFirstSegment;
+        g_queueFirstSegment = segment->next;
+        if (!g_queueFirstSegment) {
+            g_queueLastSegment = nullptr;
+            g_queueTail = 0;
+        }
+        releaseQueueSegment(segment);
+        g_queueHead = 0;
+    } else if (g_queueSize == 0) {
+        g_queueHead = 0;
+        g_queueTail = 0;
+    }
     if (!continuousTask) {
         --g_numNonContinuousTaskInQueue;
 	    onRemoveFromQueue();
     }
 }
 bool isInQueue(FlowState *flowState, unsigned componentIndex) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return false;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
-            return true;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
+    return flowState->componenentQueuedTasks[componentIndex] > 0;
+}
+void removeTasksFromQueueForFlowState(FlowState *flowState) {
+    for (auto task = flowState->firstQueueTask; task; ) {
+        auto nextTask = task->nextInFlowState;
+        flowState->componenentQueuedTasks[task->componentIndex]--;
+        task->flowState = nullptr;
+        task->nextInFlowState = nullptr;
+        task = nextTask;
+    }
+    flowState->firstQueueTask = nullptr;
+    flowState->lastQueueTask = nullptr;
+}
+struct Timer {
+    FlowState *flowState;
+    unsigned componentIndex;
+    uint32_t deadline;
+};
+static Timer *g_timers;
+static unsigned g_timersSize;
+static unsigned g_timersCapacity;
+static inline bool isTimerBefore(const Timer &a, const Timer &b) {
+    return (int32_t)(a.deadline - b.deadline) < 0;
+}
+static void timersSiftUp(unsigned i) {
+    Timer timer = g_timers[i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (!isTimerBefore(timer, g_timers[parent])) {
             break;
         }
-	}
-    return false;
+        g_timers[i] = g_timers[parent];
+        i = parent;
+    }
+    g_timers[i] = timer;
 }
-void removeTasksFromQueueForFlowState(FlowState *flowState) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return;
-	}
-    unsigned int it = g_queueHead;
+static void timersSiftDown(unsigned i) {
+    Timer timer = g_timers[i];
     while (true) {
-		if (g_queue[it].flowState == flowState) {
-            g_queue[it].flowState = 0;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
+        unsigned child = 2 * i + 1;
+        if (child >= g_timersSize) {
             break;
         }
-	}
+        if (child + 1 < g_timersSize && isTimerBefore(g_timers[child + 1], g_timers[child])) {
+            child++;
+        }
+        if (!isTimerBefore(g_timers[child], timer)) {
+            break;
+        }
+        g_timers[i] = g_timers[child];
+        i = child;
+    }
+    g_timers[i] = timer;
+}
+bool addTimer(FlowState *flowState, unsigned componentIndex, uint32_t deadline) {
+    if (g_timersSize == g_timersCapacity) {
+        unsigned newCapacity = g_timersCapacity ? 2 * g_timersCapacity : 16;
+        auto newTimers = (Timer *)alloc(newCapacity * sizeof(Timer), 0x3a8c51e7);
+        if (!newTimers) {
+            throwError(flowState, componentIndex, "Out of memory while adding timer\n");
+            return false;
+        }
+        if (g_timers) {
+            memcpy(newTimers, g_timers, g_timersSize * sizeof(Timer));
+            free(g_timers);
+        }
+        g_timers = newTimers;
+        g_timersCapacity = newCapacity;
+    }
+    auto &timer = g_timers[g_timersSize];
+    timer.flowState = flowState;
+    timer.componentIndex = componentIndex;
+    timer.deadline = deadline;
+    timersSiftUp(g_timersSize++);
+    return true;
+}
+void processTimers() {
+    if (g_timersSize == 0) {
+        return;
+    }
+    uint32_t now = millis();
+    while (g_timersSize > 0 && (int32_t)(now - g_timers[0].deadline) >= 0) {
+        if (!addToQueue(g_timers[0].flowState, g_timers[0].componentIndex, -1, -1, -1, true)) {
+            break;
+        }
+        g_timers[0] = g_timers[--g_timersSize];
+        if (g_timersSize > 0) {
+            timersSiftDown(0);
+        }
+    }
+}
+bool getNextTimerDeadline(uint32_t &deadline) {
+    if (g_timersSize == 0) {
+        return false;
+    }
+    deadline = g_timers[0].deadline;
+    return true;
+}
+void timersReset() {
+    if (g_timers) {
+        free(g_timers);
+    }
+    g_timers = nullptr;
+    g_timersSize = 0;
+    g_timersCapacity = 0;
+}
+void removeTimersForFlowState(FlowState *flowState) {
+    unsigned j = 0;
+    for (unsigned i = 0; i < g_timersSize; i++) {
+        if (g_timers[i].flowState != flowState) {
+            g_timers[j++] = g_timers[i];
+        }
+    }
+    if (j == g_timersSize) {
+        return;
+    }
+    g_timersSize = j;
+    for (unsigned i = g_timersSize / 2; i-- > 0; ) {
+        timersSiftDown(i);
+    }
 }
 } 
 } 
@@ -9872,11 +12839,20 @@ void removeTasksFromQueueForFlowState(FlowState *flowState) {
 namespace eez {
 namespace flow {
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex);
+struct WatchDependency {
+    const Value *pValue;
+    WatchListNode *node;
+    WatchDependency *nextInBucket;
+    WatchDependency *nextInNode;
+};
 struct WatchListNode {
     FlowState *flowState;
     unsigned componentIndex;
     WatchListNode *prev;
     WatchListNode *next;
+    WatchDependency *dependencies;
+    bool tracked;
+    bool dirty;
 };
 struct WatchList {
     WatchListNode *first;
@@ -9884,6 +12860,32 @@ struct WatchList {
     unsigned       size;
 };
 static WatchList g_watchList;
+static const unsigned WATCH_DEPENDENCIES_HASH_SIZE = 64;
+static const unsigned WATCH_MAX_DEPENDENCIES = 16;
+static WatchDependency *g_watchDependenciesHash[WATCH_DEPENDENCIES_HASH_SIZE];
+static unsigned g_numWatchDependencies;
+static bool g_allWatchesDirty;
+bool g_isRecordingWatchDependencies;
+static const Value *g_recordedWatchDependencies[WATCH_MAX_DEPENDENCIES];
+static unsigned g_numRecordedWatchDependencies;
+static bool g_recordedWatchIsUntracked;
+static inline unsigned getWatchDependencyBucket(const Value *pValue) {
+    return (unsigned)(((uintptr_t)pValue / sizeof(Value)) & (WATCH_DEPENDENCIES_HASH_SIZE - 1));
+}
+static void freeWatchDependencies(WatchListNode *node) {
+    for (auto dependency = node->dependencies; dependency; ) {
+        auto nextDependency = dependency->nextInNode;
+        auto pBucket = &g_watchDependenciesHash[getWatchDependencyBucket(dependency->pValue)];
+        while (*pBucket != dependency) {
+            pBucket = &(*pBucket)->nextInBucket;
+        }
+        *pBucket = dependency->nextInBucket;
+        free(dependency);
+        g_numWatchDependencies--;
+        dependency = nextDependency;
+    }
+    node->dependencies = nullptr;
+}
 WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     auto node = (WatchListNode *)alloc(sizeof(WatchListNode), 0x00864d67);
     node->prev = g_watchList.last;
@@ -9897,6 +12899,9 @@ WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     node->next = 0;
     node->flowState = flowState;
     node->componentIndex = componentIndex;
+    node->dependencies = nullptr;
+    node->tracked = false;
+    node->dirty = true;
     incRefCounterForFlowState(flowState);
     (g_watchList.size)++;
     return node;
@@ -9912,13 +12917,20 @@ void watchListRemove(WatchListNode *node) {
     } else {
         g_watchList.last = node->prev;
     }
+    freeWatchDependencies(node);
     free(node);
     g_watchList.size > 0 ? (g_watchList.size)-- : 0;
 }
 void visitWatchList() {
+    if (g_allWatchesDirty) {
+        g_allWatchesDirty = false;
+        for (auto node = g_watchList.first; node; node = node->next) {
+            node->dirty = true;
+        }
+    }
     for (auto node = g_watchList.first; node; ) {
         auto nextNode = node->next;
-        if (canExecuteStep(node->flowState, node->componentIndex)) {
+        if ((!node->tracked || node->dirty) && canExecuteStep(node->flowState, node->componentIndex)) {
             executeWatchVariableComponent(node->flowState, node->componentIndex);
         }
         decRefCounterForFlowState(node->flowState);
@@ -9936,6 +12948,7 @@ void watchListReset() {
         watchListRemove(node);
         node = nextNode;
     }
+    g_allWatchesDirty = false;
 }
 void removeWatchesForFlowState(FlowState *flowState) {
     for (auto node = g_watchList.first; node;) {
@@ -9949,5 +12962,66 @@ void removeWatchesForFlowState(FlowState *flowState) {
 unsigned getWatchListSize() {
     return g_watchList.size;
 }
+void beginRecordingWatchDependencies() {
+    g_isRecordingWatchDependencies = true;
+    g_numRecordedWatchDependencies = 0;
+    g_recordedWatchIsUntracked = false;
+}
+void recordWatchDependency(const Value *pValue) {
+    for (unsigned i = 0; i < g_numRecordedWatchDependencies; i++) {
+        if (g_recordedWatchDependencies[i] == pValue) {
+            return;
+        }
+    }
+    if (g_numRecordedWatchDependencies == WATCH_MAX_DEPENDENCIES) {
+        g_recordedWatchIsUntracked = true;
+        return;
+    }
+    g_recordedWatchDependencies[g_numRecordedWatchDependencies++] = pValue;
+}
+void recordUntrackedWatchDependency() {
+    g_recordedWatchIsUntracked = true;
+}
+void endRecordingWatchDependencies(WatchListNode *node) {
+    g_isRecordingWatchDependencies = false;
+    if (!node) {
+        return;
+    }
+    freeWatchDependencies(node);
+    node->tracked = false;
+    node->dirty = false;
+    if (g_recordedWatchIsUntracked) {
+        return;
+    }
+    for (unsigned i = 0; i < g_numRecordedWatchDependencies; i++) {
+        auto dependency = (WatchDependency *)alloc(sizeof(WatchDependency), 0x5c3e9b41);
+        if (!dependency) {
+            freeWatchDependencies(node);
+            return;
+        }
+        auto pBucket = &g_watchDependenciesHash[getWatchDependencyBucket(g_recordedWatchDependencies[i])];
+        dependency->pValue = g_recordedWatchDependencies[i];
+        dependency->node = node;
+        dependency->nextInBucket = *pBucket;
+        dependency->nextInNode = node->dependencies;
+        *pBucket = dependency;
+        node->dependencies = dependency;
+        g_numWatchDependencies++;
+    }
+    node->tracked = true;
+}
+void onWatchedValueChanged(const Value *pValue) {
+    if (g_numWatchDependencies == 0) {
+        return;
+    }
+    for (auto dependency = g_watchDependenciesHash[getWatchDependencyBucket(pValue)]; dependency; dependency = dependency->nextInBucket) {
+        if (dependency->pValue == pValue) {
+            dependency->node->dirty = true;
+        }
+    }
+}
+void markAllWatchesDirty() {
+    g_allWatchesDirty = true;
+}
 } 
 } 
\ No newline at end of file
@@ -45,6 +45,9 @@
 #ifndef EEZ_OPTION_FS
     #define EEZ_OPTION_FS 1
 #endif
+#ifndef EEZ_OPTION_ALLOC_PROFILE
+    #define EEZ_OPTION_ALLOC_PROFILE 0
+#endif
 #ifndef OPTION_KEYBOARD
     #define OPTION_KEYBOARD 0
 #endif
@@ -188,7 +191,8 @@ Unit getSmallestUnit(Unit unit, float min, float precision);
     VALUE_TYPE(JSON_MEMBER_VALUE)                   \
     VALUE_TYPE(EVENT)                               \
     VALUE_TYPE(PROPERTY_REF)                        \
-    CUSTOM_VALUE_TYPES
+    CUSTOM_VALUE_TYPES                              \
+    VALUE_TYPE(SHA256_CONTEXT)
 namespace eez {
 #define VALUE_TYPE(NAME) VALUE_TYPE_##NAME,
 enum ValueType {
@@ -216,7 +220,18 @@ template<class T> struct ObjectAllocator {
 		free(ptr);
 	}
 };
+void trimAllocHeap();
 void getAllocInfo(uint32_t &free, uint32_t &alloc);
+#define EEZ_HAS_ALLOC_STATS 1
+struct AllocStats {
+    uint32_t id;
+    uint32_t liveBytes;
+    uint32_t liveCount;
+    uint32_t totalCount;
+    uint32_t peakBytes;
+};
+uint32_t getNumAllocStats();
+uint32_t getAllocStats(AllocStats *stats, uint32_t maxStats);
 } 
 // -----------------------------------------------------------------------------
 // flow/flow_defs_v3.h
@@ -647,6 +662,9 @@ enum OperationTypes {
     OPERATION_TYPE_FLOW_GET_BITMAP_INDEX = 70,
     OPERATION_TYPE_FLOW_GET_BITMAP_AS_DATA_URL = 78,
     OPERATION_TYPE_CRYPTO_SHA256 = 74,
+    OPERATION_TYPE_CRYPTO_SHA256_INIT = 102,
+    OPERATION_TYPE_CRYPTO_SHA256_UPDATE = 103,
+    OPERATION_TYPE_CRYPTO_SHA256_FINAL = 104,
     OPERATION_TYPE_DATE_NOW = 34,
     OPERATION_TYPE_DATE_TO_STRING = 35,
     OPERATION_TYPE_DATE_TO_LOCALE_STRING = 59,
@@ -686,6 +704,17 @@ enum OperationTypes {
     OPERATION_TYPE_ARRAY_INSERT = 56,
     OPERATION_TYPE_ARRAY_REMOVE = 57,
     OPERATION_TYPE_ARRAY_CLONE = 58,
+    OPERATION_TYPE_ARRAY_SUM = 91,
+    OPERATION_TYPE_ARRAY_MIN = 92,
+    OPERATION_TYPE_ARRAY_MAX = 93,
+    OPERATION_TYPE_ARRAY_MEAN = 94,
+    OPERATION_TYPE_ARRAY_STDDEV = 95,
+    OPERATION_TYPE_ARRAY_ARG_MIN = 96,
+    OPERATION_TYPE_ARRAY_ARG_MAX = 97,
+    OPERATION_TYPE_ARRAY_ADD = 98,
+    OPERATION_TYPE_ARRAY_SUB = 99,
+    OPERATION_TYPE_ARRAY_MUL = 100,
+    OPERATION_TYPE_ARRAY_DIV = 101,
     OPERATION_TYPE_BLOB_ALLOCATE = 75,
     OPERATION_TYPE_BLOB_TO_STRING = 88,
     OPERATION_TYPE_JSON_GET = 76,
@@ -864,6 +893,7 @@ enum ArrayTypes {
 // core/value.h
 // -----------------------------------------------------------------------------
 #include <string.h>
+#include <utility>
 namespace eez {
 namespace flow {
     struct FlowState;
@@ -1006,6 +1036,11 @@ struct Value {
 	{
 		*this = value;
 	}
+	Value(Value &&value) noexcept
+		: type(VALUE_TYPE_UNDEFINED), unit(UNIT_UNKNOWN), options(0), dstValueType(VALUE_TYPE_UNDEFINED), uint64Value(0)
+	{
+		*this = std::move(value);
+	}
 	~Value() {
         freeRef();
 	}
@@ -1017,6 +1052,9 @@ struct Value {
 		}
     }
     Value& operator = (const Value &value) {
+        if (this == &value) {
+            return *this;
+        }
         freeRef();
         if (value.type == VALUE_TYPE_STRING_ASSET) {
             type = VALUE_TYPE_STRING;
@@ -1046,6 +1084,26 @@ struct Value {
         }
         return *this;
     }
+    Value& operator = (Value &&value) noexcept {
+        if (this == &value) {
+            return *this;
+        }
+        if (value.type == VALUE_TYPE_STRING_ASSET || value.type == VALUE_TYPE_ARRAY_ASSET) {
+            return *this = (const Value &)value;
+        }
+        freeRef();
+        type = value.type;
+        unit = value.unit;
+        options = value.options;
+        dstValueType = value.dstValueType;
+        memcpy((void *)&int64Value, (const void *)&value.int64Value, sizeof(int64_t));
+        value.type = VALUE_TYPE_UNDEFINED;
+        value.unit = UNIT_UNKNOWN;
+        value.options = 0;
+        value.dstValueType = VALUE_TYPE_UNDEFINED;
+        value.uint64Value = 0;
+        return *this;
+    }
     bool operator==(const Value &other) const {
 		return g_valueTypeCompareFunctions[type](*this, other);
 	}
@@ -1144,6 +1202,7 @@ struct Value {
 		return doubleValue;
 	}
 	const char *getString() const;
+    uint32_t getStringLength() const;
     const ArrayValue *getArray() const;
     ArrayValue *getArray();
 	int getInt() const {
@@ -1217,10 +1276,14 @@ struct Value {
     bool toBool(int *err = nullptr) const;
 	Value toString(uint32_t id) const;
 	static Value makeStringRef(const char *str, int len, uint32_t id);
+    static Value makeStringSliceRef(const Value &str, const char *chars, uint32_t len, uint32_t id);
+    static Value makeStringSuffixRef(const Value &str, uint32_t offset, uint32_t id);
 	static Value concatenateString(const Value &str1, const Value &str2);
     static Value makeArrayRef(int arraySize, int arrayType, uint32_t id);
+    static Value makeArrayRef(int arraySize, int arrayType, uint32_t id, uint32_t capacity);
     static Value makeArrayElementRef(Value arrayValue, int elementIndex, uint32_t id);
     static Value makeJsonMemberRef(Value jsonValue, Value propertyName, uint32_t id);
+    static Value makeJsonRef(const char *json, int len, uint32_t id);
     static Value makeBlobRef(const uint8_t *blob, uint32_t len, uint32_t id);
     static Value makeBlobRef(const uint8_t *blob1, uint32_t len1, const uint8_t *blob2, uint32_t len2, uint32_t id);
     static Value makeLVGLEventRef(uint32_t code, void *currentTarget, void *target, int32_t userData, uint32_t key, int32_t gestureDir, int32_t rotaryDiff, uint32_t id);
@@ -1261,12 +1324,13 @@ struct Value {
 	};
 };
 struct StringRef : public Ref {
-    ~StringRef() {
-        if (str) {
-            eez::free(str);
-        }
-    }
-	char *str;
+    ~StringRef();
+    uint32_t len;
+	const char *str;
+    Ref *jsonRef;
+};
+struct StringSliceRef : public StringRef {
+    Value baseValue;
 };
 struct ArrayValue {
 	uint32_t arraySize;
@@ -1275,6 +1339,7 @@ struct ArrayValue {
 };
 struct ArrayValueRef : public Ref {
     ~ArrayValueRef();
+    uint32_t capacity;
 	ArrayValue arrayValue;
 };
 struct BlobRef : public Ref {
@@ -1340,6 +1405,14 @@ inline Value Value::getValue() const {
     return *this;
 }
 bool assignValue(Value &dstValue, const Value &srcValue, uint32_t dstValueType = VALUE_TYPE_UNDEFINED);
+bool isUniqueArrayRef(const Value &arrayValue);
+bool insertArrayElement(Value &arrayValue, uint32_t position, const Value &elementValue);
+void removeArrayElement(Value &arrayValue, uint32_t position);
+void sliceArrayElements(Value &arrayValue, uint32_t from, uint32_t to);
+bool hasArrayElements(const Value &arrayValue);
+bool isPrimitiveArrayType(uint32_t arrayType);
+void copyArrayElements(Value *dstValues, const Value *srcValues, uint32_t count);
+const Value *getStructFieldValue(const Value &structValue, uint32_t fieldIndex);
 uint16_t getPageIndexFromValue(const Value &value);
 uint16_t getNumPagesFromValue(const Value &value);
 Value MakeRangeValue(uint16_t from, uint16_t to);
@@ -1389,7 +1462,7 @@ struct ArrayOfInteger {
 struct ArrayOfFloat {
     Value value;
     ArrayOfFloat(size_t size) {
-        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_INTEGER, 0);
+        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_FLOAT, 0);
     }
     ArrayOfFloat(Value value_) : value(value_) {}
     operator Value() const { return value; }
@@ -1407,7 +1480,7 @@ struct ArrayOfFloat {
 struct ArrayOfDouble {
     Value value;
     ArrayOfDouble(size_t size) {
-        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_INTEGER, 0);
+        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_DOUBLE, 0);
     }
     ArrayOfDouble(Value value_) : value(value_) {}
     operator Value() const { return value; }
@@ -1425,7 +1498,7 @@ struct ArrayOfDouble {
 struct ArrayOfBoolean {
     Value value;
     ArrayOfBoolean(size_t size) {
-        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_INTEGER, 0);
+        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_BOOLEAN, 0);
     }
     ArrayOfBoolean(Value value_) : value(value_) {}
     operator Value() const { return value; }
@@ -1443,7 +1516,7 @@ struct ArrayOfBoolean {
 struct ArrayOfString {
     Value value;
     ArrayOfString(size_t size) {
-        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_INTEGER, 0);
+        value = Value::makeArrayRef((uint32_t)size, flow::defs_v3::ARRAY_TYPE_STRING, 0);
     }
     ArrayOfString(Value value_) : value(value_) {}
     operator Value() const { return value; }
@@ -1459,6 +1532,45 @@ struct ArrayOfString {
     }
 };
 } 
+namespace eez {
+enum JsonNodeType {
+    JSON_NODE_NULL,
+    JSON_NODE_FALSE,
+    JSON_NODE_TRUE,
+    JSON_NODE_NUMBER,
+    JSON_NODE_STRING,
+    JSON_NODE_ARRAY,
+    JSON_NODE_OBJECT
+};
+struct JsonNode {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t next;
+    uint32_t size;
+};
+struct JsonRef : public Ref {
+    ~JsonRef() {
+        if (nodes && !documentValue.isJson()) {
+            eez::free(nodes);
+        }
+    }
+    Value text;
+    JsonNode *nodes;
+    uint32_t numNodes;
+    uint32_t nodeIndex;
+    Value documentValue;
+};
+bool isJsonRef(const Value &jsonValue);
+bool isSameJsonNode(const Value &a, const Value &b);
+Value getJsonProperty(const Value &jsonValue, const Value &propertyValue);
+Value getJsonMember(const Value &jsonValue, const char *name, int nameLen = -1);
+Value getJsonElement(const Value &jsonValue, int elementIndex);
+Value getJsonPath(const Value &jsonValue, const char *path);
+bool getJsonLength(const Value &jsonValue, uint32_t &length);
+void jsonToText(const Value &jsonValue, char *text, int count);
+uint32_t getJsonTextLength(const Value &jsonValue);
+Value parseJsonString(const Value &stringValue);
+} 
 // -----------------------------------------------------------------------------
 // core/action.h
 // -----------------------------------------------------------------------------
@@ -1785,6 +1897,13 @@ float remapOutExp(float x, float x1, float y1, float x2, float y2);
 float clamp(float x, float min, float max);
 void stringCopy(char *dst, size_t maxStrLength, const char *src);
 void stringCopyLength(char *dst, size_t maxStrLength, const char *src, size_t length);
+static const size_t FORMAT_INTEGER_MAX_LENGTH = 24;
+static const size_t FORMAT_DOUBLE_MAX_LENGTH = 32;
+uint32_t getDecimalDigitCount(uint64_t value);
+void writeDecimalDigits(char *str, uint64_t value, uint32_t numDigits);
+int formatUInt64(char *str, uint64_t value);
+int formatInt64(char *str, int64_t value);
+int formatDouble(char *str, double value);
 void stringAppendString(char *str, size_t maxStrLength, const char *value);
 void stringAppendStringLength(char *str, size_t maxStrLength, const char *value, size_t length);
 void stringAppendInt(char *str, size_t maxStrLength, int value);
@@ -1919,6 +2038,7 @@ struct ComponenentExecutionState {
 struct CatchErrorComponenentExecutionState : public ComponenentExecutionState {
 	Value message;
 };
+struct QueueTask;
 struct FlowState {
 	Assets *assets;
     uint32_t flowStateIndex;
@@ -1935,6 +2055,9 @@ struct FlowState {
     Value *values;
 	ComponenentExecutionState **componenentExecutionStates;
     bool *componenentAsyncStates;
+    unsigned *componenentQueuedTasks;
+    QueueTask *firstQueueTask;
+    QueueTask *lastQueueTask;
     unsigned executingComponentIndex;
     float timelinePosition;
     int32_t lvglWidgetStartIndex;
@@ -2168,6 +2291,7 @@ struct EvalStack {
 	Value stack[STACK_SIZE];
 	size_t sp = 0;
     const char *errorMessage;
+    Value *inPlaceAssignmentTarget = nullptr;
 	bool push(const Value &value) {
 		if (sp >= STACK_SIZE) {
 			throwError(flowState, componentIndex, "Evaluation stack is full\n");
@@ -2176,6 +2300,14 @@ struct EvalStack {
 		stack[sp++] = value;
 		return true;
 	}
+	bool push(Value &&value) {
+		if (sp >= STACK_SIZE) {
+			throwError(flowState, componentIndex, "Evaluation stack is full\n");
+			return false;
+		}
+		stack[sp++] = std::move(value);
+		return true;
+	}
 	bool push(Value *pValue) {
 		if (sp >= STACK_SIZE) {
 			return false;
@@ -2187,16 +2319,18 @@ struct EvalStack {
         if (sp == 0) {
             return Value::makeError();
         }
-		return stack[--sp];
+		return std::move(stack[--sp]);
 	}
     void setErrorMessage(const char *str) {
         errorMessage = str;
     }
 };
-bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
+bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr, Value *inPlaceAssignmentTarget = nullptr);
 bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
 bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
 bool evalAssignableProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
+void compileExpressions(Assets *assets);
+void freeCompiledExpressions();
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2212,6 +2346,7 @@ unsigned start(Assets *assets);
 void tick();
 void stop(Assets* assets = nullptr);
 bool isFlowStopped();
+bool getNextTickDeadline(uint32_t &deadline);
 unsigned getTickMaxDurationCounter();
 FlowState *getPageFlowState(Assets *assets, int16_t pageIndex);
 int getPageIndex(FlowState *flowState);
@@ -2314,6 +2449,11 @@ bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool
 void removeNextTaskFromQueue();
 bool isInQueue(FlowState *flowState, unsigned componentIndex);
 void removeTasksFromQueueForFlowState(FlowState *flowState);
+bool addTimer(FlowState *flowState, unsigned componentIndex, uint32_t deadline);
+void processTimers();
+bool getNextTimerDeadline(uint32_t &deadline);
+void timersReset();
+void removeTimersForFlowState(FlowState *flowState);
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2328,6 +2468,13 @@ void visitWatchList();
 void watchListReset();
 void removeWatchesForFlowState(FlowState *flowState);
 unsigned getWatchListSize();
+extern bool g_isRecordingWatchDependencies;
+void beginRecordingWatchDependencies();
+void recordWatchDependency(const Value *pValue);
+void recordUntrackedWatchDependency();
+void endRecordingWatchDependencies(WatchListNode *node);
+void onWatchedValueChanged(const Value *pValue);
+void markAllWatchesDirty();
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2538,7 +2685,7 @@ struct SortArrayActionComponent : public Component {
     int32_t structFieldIndex;
     uint32_t flags;
 };
-void sortArray(SortArrayActionComponent *component, ArrayValue *array);
+bool sortArray(SortArrayActionComponent *component, ArrayValue *array);
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2627,6 +2774,7 @@ void eez_flow_set_create_screen_func(void (*createScreenFunc)(int screenIndex));
 void eez_flow_set_delete_screen_func(void (*deleteScreenFunc)(int screenIndex));
 void eez_flow_tick();
 bool eez_flow_is_stopped();
+bool eez_flow_get_next_tick_deadline(uint32_t *deadline);
 extern int16_t g_currentScreen;
 int16_t eez_flow_get_current_screen();
 void eez_flow_set_screen(int16_t screenId, lv_scr_load_anim_t animType, uint32_t speed, uint32_t delay);
@@ -59,6 +59,10 @@ const LVGL_INCLUDE2 = `#if defined(EEZ_FOR_LVGL)
 #endif
 `;
 const OUT_DIR = "../../../release/eez-framework-amalgamation";
+// local changes to the generated sources, applied in file name order after
+// the amalgamation is written; each patch is relative to the repository root
+const PATCHES_DIR = "../patches";
+const REPO_ROOT = path_1.default.resolve("../../..");
 ////////////////////////////////////////////////////////////////////////////////
 const EEZ_FRAMEWORK_PATH = path_1.default.resolve("../../../eez-framework");
 const BASE_PATH = path_1.default.resolve(EEZ_FRAMEWORK_PATH + "/src/eez");
@@ -366,6 +370,28 @@ extern "C" {
     });
 }
 ////////////////////////////////////////////////////////////////////////////////
+function applyPatches() {
+    return __awaiter(this, void 0, void 0, function* () {
+        const patches = (yield fs_1.default.promises.readdir(PATCHES_DIR))
+            .filter(fileName => fileName.endsWith(".patch"))
+            .sort();
+        for (const fileName of patches) {
+            const patchPath = path_1.default.resolve(PATCHES_DIR, fileName);
+            yield new Promise((resolve, reject) => {
+                (0, child_process_1.exec)(`git apply --whitespace=nowarn "${patchPath}"`, { cwd: REPO_ROOT }, function (error, stdout, stderr) {
+                    if (error) {
+                        reject(`failed to apply ${fileName}:\n${stderr}`);
+                    }
+                    else {
+                        resolve();
+                    }
+                });
+            });
+            console.log(`applied ${fileName}`);
+        }
+    });
+}
+////////////////////////////////////////////////////////////////////////////////
 walk(BASE_PATH, (err, results) => __awaiter(void 0, void 0, void 0, function* () {
     if (err) {
         console.error(err);
@@ -430,4 +456,11 @@ walk(BASE_PATH, (err, results) => __awaiter(void 0, void 0, void 0, function* ()
     sha256_c = sha256_c.replace('#include "sha256.h"', '#include "eez-flow-sha256.h"');
     yield fs_1.default.promises.writeFile(OUT_DIR + "/eez-flow-sha256.c", sha256_c, "utf-8");
     yield fs_1.default.promises.cp(BASE_PATH + "/libs/sha256/sha256.h", OUT_DIR + "/eez-flow-sha256.h");
+    try {
+        yield applyPatches();
+    }
+    catch (err) {
+        console.error(err);
+        process.exit(-3);
+    }
 }));
@@ -52,6 +52,11 @@ const LVGL_INCLUDE2 = `#if defined(EEZ_FOR_LVGL)
 
 const OUT_DIR = "../../../release/eez-framework-amalgamation";
 
+// local changes to the generated sources, applied in file name order after
+// the amalgamation is written; each patch is relative to the repository root
+const PATCHES_DIR = "../patches";
+const REPO_ROOT = path.resolve("../../..");
+
 ////////////////////////////////////////////////////////////////////////////////
 
 const EEZ_FRAMEWORK_PATH = path.resolve("../../../eez-framework");
@@ -393,6 +398,32 @@ extern "C" {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+async function applyPatches() {
+    const patches = (await fs.promises.readdir(PATCHES_DIR))
+        .filter(fileName => fileName.endsWith(".patch"))
+        .sort();
+
+    for (const fileName of patches) {
+        const patchPath = path.resolve(PATCHES_DIR, fileName);
+        await new Promise<void>((resolve, reject) => {
+            exec(
+                `git apply --whitespace=nowarn "${patchPath}"`,
+                { cwd: REPO_ROOT },
+                function (error, stdout, stderr) {
+                    if (error) {
+                        reject(`failed to apply ${fileName}:\n${stderr}`);
+                    } else {
+                        resolve();
+                    }
+                }
+            );
+        });
+        console.log(`applied ${fileName}`);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 walk(BASE_PATH, async (err, results) => {
     if (err) {
         console.error(err);
@@ -503,4 +534,11 @@ walk(BASE_PATH, async (err, results) => {
         BASE_PATH + "/libs/sha256/sha256.h",
         OUT_DIR + "/eez-flow-sha256.h"
     );
+
+    try {
+        await applyPatches();
+    } catch (err) {
+        console.error(err);
+        process.exit(-3);
+    }
 });